@@ -0,0 +1,119 @@
+/**
+ * @file	gemini_extract_bench.cpp
+ * @brief	Benchmark of the extraction of text from Google Gemini responses:
+ *          SAX extraction (extractTextFromGemini) versus a full JSON document
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "gemini.h"
+
+/**
+ * @brief Extracts the text of the first candidate by building the whole
+ *        JSON document, as extractTextFromGemini used to do
+ *
+ * @param response Response in JSON format
+ * @return Concatenated text of the parts of the first candidate
+ */
+std::string extractWithDocument(const std::string& response) {
+    std::string text;
+    json j = json::parse(response);
+    if (j.contains("candidates") && !j["candidates"].empty()) {
+        for (const json& part : j["candidates"][0]["content"]["parts"]) {
+            text += part["text"].get<std::string>();
+        }
+    }
+    return text;
+}
+
+/**
+ * @brief Builds a response similar to the ones of Google Gemini
+ *
+ * @param numurls Number of URLs in the text of each part
+ * @param numparts Number of parts of each candidate
+ * @param numcandidates Number of candidates
+ * @return Response in JSON format
+ */
+std::string makeResponse(int numurls, int numparts, int numcandidates) {
+    json candidates = json::array();
+    for (int c = 0; c < numcandidates; c++) {
+        json parts = json::array();
+        for (int p = 0; p < numparts; p++) {
+            std::string text;
+            for (int u = 0; u < numurls; u++) {
+                text += "https://images.example.org/collection/" + std::to_string(c) + "/" +
+                        std::to_string(p) + "/" + std::to_string(u) + ".jpg\n";
+            }
+            parts.push_back({{"text", text}});
+        }
+        candidates.push_back({{"content", {{"parts", parts}, {"role", "model"}}},
+                              {"finishReason", "STOP"},
+                              {"avgLogprobs", -0.0421},
+                              {"index", c}});
+    }
+    json tokens = json::array();
+    for (int i = 0; i < 64; i++) tokens.push_back({{"modality", "TEXT"}, {"tokenCount", i}});
+    json response = {{"candidates", candidates},
+                     {"usageMetadata", {{"promptTokenCount", 57},
+                                        {"candidatesTokenCount", 2048},
+                                        {"promptTokensDetails", tokens}}},
+                     {"modelVersion", "gemini-2.5-flash-lite"},
+                     {"responseId", "bench"}};
+    return response.dump();
+}
+
+/**
+ * @brief Measures the mean time of an extraction function
+ *
+ * @param name Name of the approach
+ * @param response Response in JSON format
+ * @param iterations Number of iterations
+ * @param extract Extraction function
+ * @return Extracted text (of the last iteration)
+ */
+template <typename Function>
+std::string measure(const char* name, const std::string& response, int iterations,
+                    Function extract) {
+    std::string text;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) text = extract(response);
+    double elapsed = std::chrono::duration<double, std::micro>(
+                         std::chrono::steady_clock::now() - start).count();
+    std::cout << "  " << name << ": " << elapsed / iterations << " us per response"
+              << std::endl;
+    return text;
+}
+
+/**
+ * @brief Main function
+ * @details Usage: gemini_extract_bench [ITERATIONS]
+ *
+ * @param argc Number of command-line arguments
+ * @param argv Command-line arguments
+ * @return Execution status
+ */
+int main(int argc, char* argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200;
+    const int shapes[][3] = {{10, 1, 1}, {100, 4, 1}, {100, 4, 8}, {1000, 8, 8}};
+    for (const auto& shape : shapes) {
+        std::string response = makeResponse(shape[0], shape[1], shape[2]);
+        std::cout << shape[0] << " URLs x " << shape[1] << " parts x " << shape[2]
+                  << " candidates (" << response.size() / 1024 << " KB):" << std::endl;
+        std::string dom = measure("document", response, iterations, extractWithDocument);
+        std::string sax = measure("SAX", response, iterations, extractTextFromGemini);
+        if (dom != sax) {
+            std::cerr << "Error: the extracted texts differ" << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
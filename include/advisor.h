@@ -0,0 +1,52 @@
+/**
+ * @file	advisor.h
+ * @brief	Analysis of the bottlenecks of a run
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef ADVISOR_H
+#define ADVISOR_H
+
+#include <ostream>
+#include <vector>
+
+#include "progress.h"
+
+/** @brief Fraction of its workers above which a pool is saturated */
+#define ADVISOR_SATURATED 0.8
+
+/** @brief Fraction of the run above which the idle time of a pool is flagged */
+#define ADVISOR_IDLE 0.5
+
+/** @brief Mean items waiting above which a pool is considered behind */
+#define ADVISOR_MIN_QUEUE 0.5
+
+/**
+ * @brief Prints an analysis of the load of the pools of workers over a run
+ * @details The limiting pool is the one whose workers were all busy for the
+ *          longest time (or, if none was, the busiest one). For each pool,
+ *          Little's law relates the mean busy workers L, the throughput X
+ *          and the time W each item spends in the pool (L = XW), and the
+ *          same holds for the items waiting for it. A saturated pool with
+ *          items waiting would keep up with its arrivals with as many
+ *          workers as items present on average (busy plus waiting), which
+ *          would shorten its active time by the ratio between both; the
+ *          estimated time of the run assumes the rest of the run unchanged,
+ *          so it is optimistic once another pool becomes the limit. A
+ *          saturated pool without items waiting is starved by the stages
+ *          before it, a pool with items waiting for free workers is limited
+ *          by something else (e.g., limits per host), and a pool with few
+ *          workers busy is oversized. Pools idle for more than ADVISOR_IDLE
+ *          of the run are flagged, as their work could overlap with that of
+ *          the others
+ *
+ * @param pools Load of each pool over the run (see Progress::loads())
+ * @param seconds Duration (in seconds) of the run
+ * @param out Output stream
+ */
+void printBottleneckAnalysis(const std::vector<PoolLoad>& pools, double seconds,
+                             std::ostream& out);
+
+#endif
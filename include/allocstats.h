@@ -0,0 +1,64 @@
+/**
+ * @file	allocstats.h
+ * @brief	Accounting of the memory allocations of each task
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef ALLOCSTATS_H
+#define ALLOCSTATS_H
+
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include "task.h"
+
+/** @brief Allocations made by the threads working on a task */
+struct TaskAllocations {
+    Task task = Task::None;  ///< Task
+    uint64_t allocations = 0;  ///< Blocks allocated (including reallocated)
+    uint64_t bytes = 0;        ///< Bytes allocated
+    uint64_t frees = 0;        ///< Blocks freed
+    uint64_t freedBytes = 0;   ///< Bytes freed
+    uint64_t peakLive = 0;     ///< Highest bytes live in the process after an allocation of the task
+};
+
+/**
+ * @brief Starts accounting the allocations of the process
+ * @details Allocations are intercepted by replacing the allocation
+ *          functions of the C library (malloc, calloc, realloc, free and the
+ *          aligned variants) on glibc, which also covers operator new and
+ *          the allocations of the libraries (e.g., libcurl and OpenCV), or
+ *          by replacing the global operator new and delete elsewhere. Each
+ *          allocation is attributed to the task of the allocating thread
+ *          (see TaskScope) and sized by the allocator (malloc_usable_size),
+ *          with a few relaxed atomic operations. Until accounting starts,
+ *          the replacements only check whether it did
+ */
+void startAllocationStats();
+
+/**
+ * @brief Checks whether allocations are accounted
+ *
+ * @return true if accounting started, false otherwise
+ */
+bool allocationStatsEnabled();
+
+/**
+ * @brief Retrieves the allocations of each task so far
+ *
+ * @return Allocations of each task that allocated memory
+ */
+std::vector<TaskAllocations> allocationStats();
+
+/**
+ * @brief Prints the allocations of each task as a table
+ *
+ * @param stats Allocations of each task
+ * @param out Output stream
+ */
+void printAllocationStats(const std::vector<TaskAllocations>& stats, std::ostream& out);
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ * @file	crawler.h
+ * @brief	Crawler extracting image URLs from HTML pages
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef CRAWLER_H
+#define CRAWLER_H
+
+#include <curl/curl.h>
+
+#include <deque>
+#include <functional>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "urlsource.h"
+
+/** @brief Default number of links followed from the seed pages */
+#define CRAWLER_MAX_DEPTH 1
+
+/** @brief Maximum number of pages fetched by a crawl */
+#define CRAWLER_MAX_PAGES 200
+
+/** @brief Maximum number of pages fetched at the same time */
+#define CRAWLER_MAX_CONCURRENT 8
+
+/** @brief Maximum size (in bytes) of a page scanned */
+#define CRAWLER_MAX_PAGE_SIZE (4L * 1024 * 1024)
+
+/**
+ * @brief Streaming scanner of the attributes of HTML tags that link to images
+ *        or pages
+ * @details The page is fed in chunks as it arrives, and a state machine
+ *          tokenizes tags and their attributes byte by byte, without building
+ *          a DOM or keeping more than the current attribute. Comments and
+ *          the contents of script and style elements are skipped. The
+ *          attributes reported are src, data-src and srcset of img and source
+ *          tags, and href of a and base tags, with &amp; decoded
+ */
+class HtmlLinkScanner {
+public:
+    /** @brief Function called with the tag name, attribute name and attribute value */
+    using Handler = std::function<void(const std::string& tag, const std::string& attr,
+                                       const std::string& value)>;
+
+    /**
+     * @brief Creates the scanner
+     *
+     * @param handler Function called for each attribute reported
+     */
+    explicit HtmlLinkScanner(Handler handler);
+
+    /**
+     * @brief Scans the next chunk of a page
+     *
+     * @param data Chunk
+     * @param size Chunk size
+     */
+    void feed(const char* data, size_t size);
+
+private:
+    /** @brief States of the tokenizer */
+    enum class State {
+        Text, TagOpen, TagName, BeforeAttr, AttrName, AfterAttrName, BeforeValue,
+        QuotedValue, UnquotedValue, SkipTag, SkipQuoted, Comment, RawText
+    };
+
+    bool interesting() const;
+    void endAttribute();
+    void endTag();
+
+    Handler handler_;
+    State state_ = State::Text;
+    std::string tag_;        ///< Name of the current tag
+    bool closing_ = false;   ///< Whether the current tag is an end tag
+    std::string attr_;       ///< Name of the current attribute
+    std::string value_;      ///< Value of the current attribute
+    char quote_ = 0;         ///< Quote delimiting the current value
+    size_t dashes_ = 0;      ///< Consecutive dashes seen in a comment
+    std::string rawEnd_;     ///< End tag closing the current script or style
+    size_t rawMatched_ = 0;  ///< Characters of rawEnd_ matched so far
+};
+
+/**
+ * @brief Source crawling HTML pages (e.g., galleries or indexes) for image URLs
+ * @details Pages are fetched concurrently through a libcurl multi handle and
+ *          scanned by an HtmlLinkScanner as they arrive. Images are found in
+ *          img and source tags (the largest candidate of a srcset) and in
+ *          links directly pointing to JPEG, PNG or WebP files. Other links,
+ *          resolved against the page URL (or its base tag), are followed up to
+ *          maxDepth links away from the seeds and, if sameHost is set, only
+ *          to the hosts of the seeds. Image URLs are returned as soon as
+ *          enough are found, and the crawl resumes on the next pull
+ */
+class CrawlerUrlSource final : public UrlSource {
+public:
+    /**
+     * @brief Creates the source
+     *
+     * @param seeds URLs of the pages where the crawl starts
+     * @param maxDepth Number of links followed from the seeds
+     * @param sameHost Whether only links to the hosts of the seeds are followed
+     */
+    CrawlerUrlSource(const std::vector<std::string>& seeds, int maxDepth = CRAWLER_MAX_DEPTH,
+                     bool sameHost = true);
+    ~CrawlerUrlSource() override;
+
+    std::string name() const override;
+
+protected:
+    std::vector<std::string> produce(size_t count) override;
+
+private:
+    struct Page;
+
+    void start(const std::string& url, int depth);
+    void found(Page& page, const std::string& tag, const std::string& attr,
+               const std::string& value);
+    static size_t writeCallback(char* data, size_t size, size_t count, void* userp);
+
+    std::vector<std::string> seeds_;
+    int maxDepth_;
+    bool sameHost_;
+    std::set<std::string> hosts_;                  ///< Hosts of the seeds
+    CURLM* multi_;
+    std::deque<std::pair<std::string, int>> frontier_;  ///< Pages to fetch and their depth
+    std::vector<std::unique_ptr<Page>> pages_;     ///< Pages being fetched
+    std::set<std::string> seenPages_;              ///< Pages already queued
+    std::set<std::string> seenImages_;             ///< Images already found
+    std::deque<std::string> images_;               ///< Images found, not yet pulled
+    size_t fetched_ = 0;                           ///< Pages started
+};
+
+#endif
@@ -0,0 +1,100 @@
+/**
+ * @file	dnscache.h
+ * @brief	Cache of resolved host names shared by all HTTP requests
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef DNSCACHE_H
+#define DNSCACHE_H
+
+#include <curl/curl.h>
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Time (in seconds) a resolved host name is kept in the cache
+ * @details getaddrinfo() does not report the TTL of the DNS records, so
+ *          every entry is kept for this fixed time
+ */
+#define DNS_CACHE_TTL 300
+
+/** @brief Maximum number of host names looked up at the same time by a prefetch */
+#define DNS_CACHE_MAX_LOOKUPS 8
+
+/**
+ * @brief Cache of resolved host names shared by all HTTP requests
+ * @details Every libcurl easy handle starts with an empty resolver cache,
+ *          so each new handle would look the host up again. Instead, the
+ *          distinct hosts of a batch of URLs are resolved concurrently in
+ *          advance (by up to DNS_CACHE_MAX_LOOKUPS threads) and the
+ *          addresses are handed to libcurl through CURLOPT_RESOLVE. Entries
+ *          expire after DNS_CACHE_TTL seconds, whatever the TTL of the
+ *          records, and can be persisted to a file between runs
+ */
+class DnsCache {
+public:
+    /** @brief Cache shared by the whole process */
+    static DnsCache& instance();
+
+    ~DnsCache();
+
+    /**
+     * @brief Resolves concurrently the distinct hosts of a batch of URLs
+     *        that are not in the cache (or whose entry expired)
+     * @details The calling thread and up to DNS_CACHE_MAX_LOOKUPS - 1 other
+     *          threads look the hosts up, each host being cached as soon as
+     *          it is resolved
+     *
+     * @param urls URLs whose hosts are resolved
+     */
+    void prefetch(const std::vector<std::string>& urls);
+
+    /**
+     * @brief Provides the cached addresses of the host of a URL to libcurl
+     * @details It never blocks on a lookup: if the host is not cached,
+     *          libcurl resolves it as usual
+     *
+     * @param curl Easy handle that will request the URL
+     * @param url URL to request
+     */
+    void apply(CURL* curl, const std::string& url);
+
+    /**
+     * @brief Loads the entries persisted by an earlier run, skipping the
+     *        expired ones
+     *
+     * @param filename Cache file
+     */
+    void load(const std::string& filename);
+
+    /**
+     * @brief Persists the entries that did not expire
+     *
+     * @param filename Cache file
+     */
+    void save(const std::string& filename) const;
+
+private:
+    /** @brief Addresses of a host */
+    struct Entry {
+        std::vector<std::string> addresses;             ///< IPv4/IPv6 addresses
+        std::chrono::system_clock::time_point expires;  ///< Expiration time
+        std::map<long, struct curl_slist*> lists;       ///< CURLOPT_RESOLVE list by port
+    };
+
+    void store(const std::string& host, const Entry& entry);
+
+    DnsCache() = default;
+
+    mutable std::mutex mutex_;                   ///< Guards the members below
+    std::map<std::string, Entry> entries_;       ///< Entries by host name
+    std::vector<struct curl_slist*> retired_;    ///< Lists of replaced entries
+};
+
+#endif
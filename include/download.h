@@ -0,0 +1,279 @@
+/**
+ * @file	download.h
+ * @brief	Functions to download images from their URLs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef DOWNLOAD_H
+#define DOWNLOAD_H
+
+#include <curl/curl.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** @brief Minimum body size (in bytes) for a download to be split into segments */
+#define SEGMENTED_DOWNLOAD_THRESHOLD (2L * 1024 * 1024)
+
+/** @brief Number of concurrent range requests used by a segmented download */
+#define SEGMENTED_DOWNLOAD_SEGMENTS 4
+
+/** @brief Maximum number of attempts to download an image */
+#define DOWNLOAD_MAX_ATTEMPTS 3
+
+/** @brief Maximum number of images downloaded at the same time */
+#define DOWNLOAD_MAX_CONCURRENT 64
+
+/** @brief Number of images downloaded at the same time when the engine starts */
+#define DOWNLOAD_INITIAL_CONCURRENT 4
+
+/** @brief Interval (in milliseconds) between adjustments of the download concurrency */
+#define DOWNLOAD_TUNE_INTERVAL_MS 1000
+
+/** @brief Maximum number of connections opened to the same host */
+#define DOWNLOAD_MAX_HOST_CONNECTIONS 6
+
+/** @brief Maximum number of concurrent HTTP/2 streams on a connection */
+#define DOWNLOAD_MAX_HOST_STREAMS 32
+
+/** @brief Maximum number of images downloaded at the same time from the same host */
+#define DOWNLOAD_MAX_HOST_ACTIVE 8
+
+/** @brief Minimum delay (in milliseconds) between starting two downloads from the same host */
+#define DOWNLOAD_HOST_DELAY_MS 20
+
+/** @brief Timing breakdown of a request, in seconds since it started */
+struct RequestTiming {
+    double nameLookup = 0;    ///< Until the host name was resolved
+    double connect = 0;       ///< Until the connection was established
+    double tlsHandshake = 0;  ///< Until the TLS handshake finished (0 without TLS)
+    double preTransfer = 0;   ///< Until the request was about to be sent
+    double firstByte = 0;     ///< Until the first byte of the response arrived
+    double total = 0;         ///< Until the request finished
+    long status = 0;          ///< HTTP status code, or 0 if there was no response
+    long httpVersion = 0;     ///< HTTP version (CURL_HTTP_VERSION_*)
+    std::string error;        ///< Error of the transfer, if it failed
+};
+
+/** @brief Outcome of a download */
+struct DownloadResult {
+    std::string url;                   ///< URL to the image
+    std::string filename;              ///< Name of the file for the downloaded image
+    bool ok = false;                   ///< Whether the image was downloaded
+    curl_off_t bytes = 0;              ///< Bytes received by all requests
+    double wait = 0;                   ///< Time (in seconds) waiting in the queue
+    double seconds = 0;                ///< Time (in seconds) from start to finish
+    int attempts = 0;                  ///< Attempts made to download the body
+    std::string effectiveUrl;          ///< URL after following redirects
+    std::vector<std::string> headers;  ///< Response headers of the HEAD request
+    RequestTiming probe;               ///< Timing of the HEAD request
+    RequestTiming slowest;             ///< Timing of the slowest request of the body
+};
+
+/** @brief Function called when a download finishes (successfully or not) */
+using DownloadCallback = std::function<void(const DownloadResult& result)>;
+
+/** @brief Queue and latency metrics of the downloads from a host */
+struct HostMetrics {
+    std::string host;        ///< Host name
+    size_t queued = 0;       ///< Downloads waiting to start
+    size_t active = 0;       ///< Downloads in progress
+    size_t completed = 0;    ///< Successful downloads
+    size_t failed = 0;       ///< Failed downloads
+    curl_off_t bytes = 0;    ///< Bytes received
+    double meanWait = 0;     ///< Mean time (in seconds) waiting in the queue
+    double meanLatency = 0;  ///< Mean time (in seconds) from start to finish
+    double p95Latency = 0;   ///< 95th percentile of the time from start to finish
+    double maxLatency = 0;   ///< Maximum time from start to finish
+};
+
+struct Download;
+
+/**
+ * @brief Engine downloading many images concurrently
+ * @details All transfers (probes and ranges of every image) are driven by
+ *          a single libcurl multi handle. HTTP/2 is preferred and transfers
+ *          to the same host are multiplexed as streams of a shared
+ *          connection (CURLPIPE_MULTIPLEX), so that images from the same
+ *          host do not pay for a connection and TLS handshake each.
+ *          Downloads wait in a queue per host. The queues are served in
+ *          round-robin, skipping hosts that already have maxHostActive
+ *          downloads in progress or that started one less than hostDelay
+ *          ago, so that a host dominating the batch is neither hammered
+ *          nor starves the others. Images are downloaded as done by
+ *          downloadImage().
+ *          The number of images in flight (the window) is tuned by
+ *          additive-increase/multiplicative-decrease (AIMD): every
+ *          tuneInterval in which the window limited the downloads, it grows
+ *          by one image if the goodput (bytes received per second) improved,
+ *          shrinks to a half if requests failed or timed out (or the hosts
+ *          answered 429/5xx) and to three quarters if the goodput dropped,
+ *          converging to the knee of the throughput curve
+ */
+class DownloadEngine {
+public:
+    /** @brief Settings of the engine */
+    struct Options {
+        size_t maxConcurrent = DOWNLOAD_MAX_CONCURRENT;       ///< Maximum images in flight
+        size_t initialConcurrent = DOWNLOAD_INITIAL_CONCURRENT;  ///< Initial images in flight
+        bool autoTune = true;                                 ///< Tune the window by AIMD
+        std::chrono::milliseconds tuneInterval{DOWNLOAD_TUNE_INTERVAL_MS};  ///< AIMD epoch
+        long maxHostConnections = DOWNLOAD_MAX_HOST_CONNECTIONS;  ///< Connections per host
+        long maxHostStreams = DOWNLOAD_MAX_HOST_STREAMS;      ///< Streams per connection
+        size_t maxHostActive = DOWNLOAD_MAX_HOST_ACTIVE;      ///< Images in flight per host
+        std::chrono::milliseconds hostDelay{DOWNLOAD_HOST_DELAY_MS};  ///< Delay between starts
+        bool http2 = true;                                    ///< Prefer HTTP/2
+    };
+
+    DownloadEngine();
+    explicit DownloadEngine(const Options& options);
+    ~DownloadEngine();
+
+    DownloadEngine(const DownloadEngine&) = delete;
+    DownloadEngine& operator=(const DownloadEngine&) = delete;
+
+    /**
+     * @brief Schedules the download of an image
+     * @details It can be called from any thread, also while run() is in
+     *          progress
+     *
+     * @param url URL to the image
+     * @param filename Name of the file for the downloaded image
+     * @param callback Function called on the thread executing run() when
+     *        the download finishes; it must not block
+     * @param id Number of the image, passed to the tracepoints (see probes.h)
+     */
+    void submit(const std::string& url, const std::string& filename,
+                DownloadCallback callback = nullptr, uint64_t id = 0);
+
+    /**
+     * @brief Signals that no more downloads will be submitted, so that run()
+     *        returns once the scheduled ones finish
+     */
+    void close();
+
+    /** @brief Performs the scheduled downloads until the engine is closed and idle */
+    void run();
+
+    /**
+     * @brief Retrieves the queue and latency metrics of each host
+     * @details It can be called from any thread, also while run() is in
+     *          progress
+     *
+     * @return Metrics of each host, in the order the hosts were first seen
+     */
+    std::vector<HostMetrics> hostMetrics() const;
+
+    /**
+     * @brief Retrieves the number of images being downloaded
+     * @details It can be called from any thread, without blocking
+     *
+     * @return Number of images in flight
+     */
+    size_t inFlight() const { return inFlight_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Retrieves the number of images allowed in flight (the window)
+     * @details It can be called from any thread, without blocking
+     *
+     * @return Size of the window
+     */
+    size_t window() const { return windowSize_.load(std::memory_order_relaxed); }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Queue and accumulated metrics of a host */
+    struct Host {
+        std::deque<std::unique_ptr<Download>> queue;  ///< Downloads waiting to start
+        size_t active = 0;                            ///< Downloads in progress
+        Clock::time_point nextStart;                  ///< Earliest time of the next start
+        size_t completed = 0;                         ///< Successful downloads
+        size_t failed = 0;                            ///< Failed downloads
+        curl_off_t bytes = 0;                         ///< Bytes received
+        double waitSum = 0;                           ///< Sum of the times in the queue
+        std::vector<double> latencies;                ///< Times from start to finish
+    };
+
+    void enqueue(std::unique_ptr<Download> download);
+    std::unique_ptr<Download> nextQueued(Clock::time_point now, int& timeout);
+    void startProbe(Download& download);
+    void finishProbe(Download& download);
+    void startAttempt(Download& download);
+    void finishAttempt(Download& download);
+    void finish(Download& download, bool ok);
+    void configure(CURL* curl) const;
+    void recordRequest(CURL* curl, CURLcode result);
+    void tune(Clock::time_point now);
+
+    Options options_;
+    CURLM* multi_;
+    std::vector<std::unique_ptr<Download>> active_;        ///< Started, not finished
+    double window_;                                        ///< Images in flight allowed
+    std::atomic<size_t> windowSize_{0};                    ///< window_, for other threads
+    std::atomic<size_t> inFlight_{0};                      ///< active_.size(), for other threads
+    curl_off_t received_ = 0;                              ///< Bytes received so far
+    Clock::time_point epochStart_;                         ///< Start of the AIMD epoch
+    curl_off_t epochReceived_ = 0;                         ///< received_ at epochStart_
+    size_t epochRequests_ = 0;                             ///< Requests finished in the epoch
+    size_t epochErrors_ = 0;                               ///< Of which failed
+    size_t epochTimeouts_ = 0;                             ///< Of which timed out
+    bool epochLimited_ = false;                            ///< Whether the window was full
+    double lastGoodput_ = 0;                               ///< Goodput of the last epoch
+    mutable std::mutex mutex_;                             ///< Guards the members below
+    std::vector<std::unique_ptr<Download>> submitted_;     ///< Not yet seen by run()
+    bool closed_ = false;
+    std::map<std::string, Host> hosts_;                    ///< Queue of each host
+    std::vector<std::string> hostOrder_;                   ///< Hosts in round-robin order
+    size_t nextHost_ = 0;                                  ///< Next host in round-robin
+    size_t queued_ = 0;                                    ///< Downloads in all queues
+};
+
+/**
+ * @brief Prints the metrics of each host as a table
+ *
+ * @param metrics Metrics of each host
+ * @param out Output stream
+ */
+void printHostMetrics(const std::vector<HostMetrics>& metrics, std::ostream& out);
+
+/**
+ * @brief Downloads an image from its URL
+ * @details Large bodies (Content-Length above SEGMENTED_DOWNLOAD_THRESHOLD)
+ *          served by hosts accepting byte ranges are split into
+ *          SEGMENTED_DOWNLOAD_SEGMENTS concurrent range requests, each one
+ *          writing directly at its offset of a preallocated file. Other
+ *          bodies are downloaded through a single request.
+ *          The body is written into a part file (filename.part) whose
+ *          progress is recorded into a sidecar file (filename.part.json).
+ *          A failed transfer is retried up to DOWNLOAD_MAX_ATTEMPTS times
+ *          and, if its host serves byte ranges and a validator (ETag or
+ *          Last-Modified), resumed from the last byte received through
+ *          Range and If-Range requests, also in a later run
+ *
+ * @param url URL to the image
+ * @param filename Name of the file for the downloaded image
+ * @return true if the image was downloaded, false otherwise
+ */
+bool downloadImage(const std::string& url, const std::string& filename);
+
+/**
+ * @brief Removes a downloaded image along with the part file and the sidecar
+ *        file its download may have left (e.g., if it failed)
+ *
+ * @param filename Name of the file for the downloaded image
+ */
+void removeDownload(const std::string& filename);
+
+#endif
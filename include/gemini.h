@@ -0,0 +1,99 @@
+/**
+ * @file	gemini.h
+ * @brief	Functions to interact with the Google Gemini API
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef GEMINI_H
+#define GEMINI_H
+
+#include <curl/curl.h>
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+/** @brief Generative AI model */
+#define GENAI_MODEL "gemini-2.5-flash-lite"
+
+/** @brief Base URL of the Google Gemini API models */
+#define GEMINI_API_URL "https://generativelanguage.googleapis.com/v1beta/models/"
+
+/** @brief Number of candidate responses requested by each URL generation request */
+#define GEMINI_CANDIDATE_COUNT 4
+
+/** @brief Bytes of the Google Gemini responses received so far */
+struct GeminiTransferStats {
+    size_t requests = 0;      ///< Requests made
+    curl_off_t received = 0;  ///< Bytes received, as transferred (compressed)
+    curl_off_t decoded = 0;   ///< Bytes after decompression
+};
+
+/**
+ * @brief A callback for libcurl.
+ * @details When libcurl is used to to perform an HTTP request, it needs to
+ *          know how to handle the incoming data (the response body).
+ *          This function is registered with CURLOPT_WRITEFUNCTION, and each
+ *          time libcurl receives a block of data, it calls this function.
+ *
+ * @param contents Pointer to the block of data received from the HTTP response
+ * @param size The size (in bytes) of each data element
+ * @param num_data The number of data elements
+ * @param userp Pointer to a string that will hold the response
+ * @return Number of bytes handled (size * num_data)
+ */
+size_t writeCallback(void* contents, size_t size, size_t num_data, void* userp);
+
+/**
+ * @brief Make an HTTP POST request to the Google Gemini API
+ * @details The response is requested compressed with any encoding libcurl
+ *          supports (gzip, and br or zstd if built with them). libcurl
+ *          decompresses it as it arrives, so the returned response is
+ *          plain JSON
+ * 
+ * @param apiKey API key to interact with the API
+ * @param prompt Prompt to be executed on Google Gemini
+ * @param candidateCount Number of candidate responses sampled for the
+ *        prompt in the same request (candidateCount)
+ * @return Output provided by Google Gemini 
+ */
+std::string postToGemini(const std::string& apiKey, const std::string& prompt,
+                         int candidateCount = 1);
+
+/**
+ * @brief Extract text from Google Gemini response
+ * @details The response is scanned with a SAX parser that only follows the
+ *          path to the text of the first candidate, without building a
+ *          document, and the text of all its parts is concatenated
+ * 
+ * @param response Response in JSON format
+ * @return Extracted text
+ */
+std::string extractTextFromGemini(const std::string& response);
+
+/**
+ * @brief Extract the text of every candidate from Google Gemini response
+ *
+ * @param response Response in JSON format
+ * @return Extracted text of each candidate
+ */
+std::vector<std::string> extractTextsFromGemini(const std::string& response);
+
+/**
+ * @brief Retrieves the bytes of the Google Gemini responses received so far
+ *
+ * @return Requests made and bytes received before and after decompression
+ */
+GeminiTransferStats geminiTransferStats();
+
+/**
+ * @brief Prints the bytes saved by compressing the Google Gemini responses
+ *
+ * @param stats Bytes of the responses
+ * @param out Output stream
+ */
+void printGeminiTransferStats(const GeminiTransferStats& stats, std::ostream& out);
+
+#endif
@@ -0,0 +1,209 @@
+/**
+ * @file	log.h
+ * @brief	Asynchronous logger with per-thread buffers
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef LOG_H
+#define LOG_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** @brief Messages each thread can buffer before new ones are dropped */
+#define LOG_RING_CAPACITY 1024
+
+/** @brief Interval (in milliseconds) between two flushes of the buffered messages */
+#define LOG_FLUSH_INTERVAL_MS 100
+
+/** @brief Identical messages from the same statement written per window before being suppressed */
+#define LOG_REPEAT_LIMIT 5
+
+/** @brief Window (in milliseconds) over which repeated messages are counted */
+#define LOG_REPEAT_WINDOW_MS 1000
+
+/** @brief Severity of a message */
+enum class LogLevel { Debug, Info, Warning, Error };
+
+/**
+ * @brief Parses the name of a level (debug, info, warning or error)
+ *
+ * @param name Name of the level
+ * @param level Parsed level
+ * @return true if the name is valid, false otherwise
+ */
+bool parseLogLevel(const std::string& name, LogLevel& level);
+
+/**
+ * @brief Asynchronous logger
+ * @details Logging threads never wait for each other nor for the output:
+ *          each thread appends its messages to its own lock-free ring
+ *          buffer (single producer, single consumer), dropping them if the
+ *          ring is full, and a background thread drains all rings every
+ *          LOG_FLUSH_INTERVAL_MS, writing each batch with a single write.
+ *          A statement logging more than LOG_REPEAT_LIMIT messages within
+ *          LOG_REPEAT_WINDOW_MS is suppressed for the rest of the window,
+ *          and the number of suppressed messages is reported instead.
+ *          Messages are written to the standard error as text (e.g.,
+ *          "Error: ...") or as JSON lines with their time, level, thread and
+ *          statement. Buffered messages are flushed when the process exits.
+ *          On a terminal, a status line (e.g., the progress of the batch)
+ *          can be kept below the messages
+ */
+class Logger {
+public:
+    /** @brief Logger shared by the whole process */
+    static Logger& instance();
+
+    ~Logger();
+
+    /**
+     * @brief Checks whether messages of a level are written
+     *
+     * @param level Level of the messages
+     * @return true if the messages are written, false otherwise
+     */
+    bool enabled(LogLevel level) const {
+        return level >= level_.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets the minimum level of the messages written
+     *
+     * @param level Minimum level
+     */
+    void setLevel(LogLevel level) { level_.store(level, std::memory_order_relaxed); }
+
+    /**
+     * @brief Sets whether messages are written as JSON lines
+     *
+     * @param json Whether messages are written as JSON lines
+     */
+    void setJson(bool json) { json_.store(json, std::memory_order_relaxed); }
+
+    /**
+     * @brief Checks whether messages are written as text to a terminal, which
+     *        can show a status line
+     *
+     * @return true if a status line can be shown, false otherwise
+     */
+    bool interactive() const { return terminal_ && !json_.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Sets the status line, redrawn below the messages with the next
+     *        flush; it is ignored unless interactive()
+     *
+     * @param line Status line, or an empty string to remove it
+     */
+    void setStatus(std::string line);
+
+    /**
+     * @brief Buffers a message, without blocking
+     *
+     * @param level Level of the message
+     * @param site Statement logging the message (file:line)
+     * @param message Message
+     */
+    void log(LogLevel level, const char* site, std::string message);
+
+    /** @brief Writes the messages buffered so far, waiting for the write */
+    void flush();
+
+private:
+    using Clock = std::chrono::system_clock;
+
+    /** @brief Buffered message */
+    struct Record {
+        Clock::time_point time;
+        LogLevel level = LogLevel::Info;
+        const char* site = "";
+        unsigned thread = 0;
+        std::string message;
+    };
+
+    /** @brief Messages buffered by a thread */
+    struct Ring {
+        Record slots[LOG_RING_CAPACITY];
+        std::atomic<size_t> head{0};      ///< Next slot read by the flusher
+        std::atomic<size_t> tail{0};      ///< Next slot written by the thread
+        std::atomic<size_t> dropped{0};   ///< Messages dropped because the ring was full
+        std::atomic<bool> closed{false};  ///< Whether the thread exited
+        unsigned thread = 0;              ///< Number of the thread
+    };
+
+    /** @brief Copies of a message logged by a statement in the current window */
+    struct Repeat {
+        const char* site = "";            ///< Statement logging the message
+        std::string message;              ///< Message repeated
+        Clock::time_point windowStart;
+        size_t count = 0;
+        size_t suppressed = 0;
+        LogLevel level = LogLevel::Info;  ///< Level of the last suppressed message
+    };
+
+    Logger();
+
+    Ring& ring();
+    void run();
+    void drain(bool all);
+    void write(const Record& record, std::string& out);
+
+    std::atomic<LogLevel> level_{LogLevel::Info};
+    std::atomic<bool> json_{false};
+    bool terminal_;                            ///< Whether the standard error is a terminal
+    std::mutex statusMutex_;                   ///< Guards status_
+    std::string status_;                       ///< Status line to show
+    std::string shown_;                        ///< Status line shown, guarded by drainMutex_
+    std::mutex ringsMutex_;                    ///< Guards rings_ and threads_
+    std::vector<std::unique_ptr<Ring>> rings_;
+    unsigned threads_ = 0;                     ///< Threads that logged so far
+    std::mutex drainMutex_;                    ///< Serializes drain()
+    std::map<std::string, Repeat> repeats_;    ///< Repeats of each statement and message
+    std::mutex stopMutex_;                     ///< Guards stop_
+    std::condition_variable stopped_;
+    bool stop_ = false;
+    std::thread flusher_;
+};
+
+/** @brief Turns a token into a string literal */
+#define LOG_STRINGIFY(x) LOG_STRINGIFY_(x)
+#define LOG_STRINGIFY_(x) #x
+
+/**
+ * @brief Logs a message built with stream insertions, e.g.
+ *        LOG(LogLevel::Error, "unable to read " << file)
+ */
+#define LOG(level, message)                                                              \
+    do {                                                                                 \
+        if (Logger::instance().enabled(level)) {                                        \
+            std::ostringstream log_stream_;                                              \
+            log_stream_ << message;                                                      \
+            Logger::instance().log(level, __FILE__ ":" LOG_STRINGIFY(__LINE__),          \
+                                   log_stream_.str());                                   \
+        }                                                                                \
+    } while (0)
+
+/** @brief Logs a debug message */
+#define LOG_DEBUG(message) LOG(LogLevel::Debug, message)
+
+/** @brief Logs an informational message */
+#define LOG_INFO(message) LOG(LogLevel::Info, message)
+
+/** @brief Logs a warning */
+#define LOG_WARNING(message) LOG(LogLevel::Warning, message)
+
+/** @brief Logs an error */
+#define LOG_ERROR(message) LOG(LogLevel::Error, message)
+
+#endif
@@ -0,0 +1,66 @@
+/**
+ * @file	mappedfile.h
+ * @brief	Read-only memory mapping of local files
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+/** @brief Maximum size (in bytes) of a file whose pages are all read when it is mapped */
+#define MAPPED_FILE_POPULATE_LIMIT (1L * 1024 * 1024)
+
+/**
+ * @brief Read-only memory mapping of a whole local file
+ * @details The pages of the file are shared with the page cache, so reading
+ *          the mapping copies nothing into the process. Files are expected
+ *          to be read once from start to end (MADV_SEQUENTIAL), so the
+ *          kernel reads ahead aggressively and drops pages behind. Files up
+ *          to MAPPED_FILE_POPULATE_LIMIT are populated when mapped
+ *          (MAP_POPULATE), replacing a page fault per page with a single call
+ */
+class MappedFile {
+public:
+    /**
+     * @brief Maps a file
+     *
+     * @param path Path to the file
+     */
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @brief Whether the file was mapped */
+    bool valid() const { return data_ != nullptr; }
+
+    /** @brief Contents of the file */
+    const unsigned char* data() const { return data_; }
+
+    /** @brief Size of the file */
+    size_t size() const { return size_; }
+
+private:
+    unsigned char* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * @brief Retrieves the local path an input URL refers to
+ * @details file:// URLs (with percent-encoded characters decoded),
+ *          absolute paths and paths relative to the working directory
+ *          starting with ./ or ../ refer to local files; anything else
+ *          (e.g., images/1.jpg or a mistyped http:/host/1.jpg) does not
+ *
+ * @param url URL or path
+ * @return Local path, or an empty string if the URL refers to a remote resource
+ */
+std::string localPathOf(const std::string& url);
+
+#endif
@@ -0,0 +1,54 @@
+/**
+ * @file	openai.h
+ * @brief	Functions to interact with OpenAI-compatible chat completion APIs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef OPENAI_H
+#define OPENAI_H
+
+#include <string>
+#include <vector>
+
+/** @brief Default base URL of an OpenAI-compatible endpoint (e.g., a local llama.cpp server) */
+#define OPENAI_API_URL "http://localhost:8080/v1"
+
+/** @brief Default model requested from an OpenAI-compatible endpoint */
+#define OPENAI_MODEL "default"
+
+/**
+ * @brief Number of choices requested by each URL generation request; servers
+ *        such as llama.cpp reject any other number than 1
+ */
+#define OPENAI_CHOICE_COUNT 1
+
+/** @brief Environment variable holding the API key to an OpenAI-compatible endpoint */
+#define OPENAI_KEY_VAR "OPENAI_API_KEY"
+
+/**
+ * @brief Make an HTTP POST request to the chat completions method of an
+ *        OpenAI-compatible API
+ *
+ * @param baseUrl Base URL of the API (e.g., http://localhost:8080/v1)
+ * @param model Model to be used
+ * @param apiKey API key sent as a bearer token (none if empty)
+ * @param prompt Prompt to be executed
+ * @param choiceCount Number of choices sampled for the prompt in the same
+ *        request (n), sent only if more than one
+ * @return Output provided by the API
+ */
+std::string postToOpenAi(const std::string& baseUrl, const std::string& model,
+                         const std::string& apiKey, const std::string& prompt,
+                         int choiceCount = 1);
+
+/**
+ * @brief Extract the message of every choice from a chat completion response
+ *
+ * @param response Response in JSON format
+ * @return Message content of each choice
+ */
+std::vector<std::string> extractTextsFromOpenAi(const std::string& response);
+
+#endif
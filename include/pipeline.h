@@ -0,0 +1,289 @@
+/**
+ * @file	pipeline.h
+ * @brief	In-process pipeline downloading and transforming batches of images
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+#include "download.h"
+#include "progress.h"
+#include "results.h"
+#include "storage.h"
+#include "urlsource.h"
+
+/** @brief Default format (extension) of the processed images */
+#define PIPELINE_DEFAULT_FORMAT ".jpg"
+
+/** @brief Format (extension) of the keys of the original images kept by a pipeline */
+#define PIPELINE_ORIGINALS_FORMAT ".jpg"
+
+/**
+ * @brief Transformation of a decoded image
+ * @details It writes into output, which may already hold a buffer of the
+ *          right size and type (e.g., wrapping memory of the caller) that
+ *          OpenCV functions then reuse
+ *
+ * @param input Image to transform
+ * @param output Transformed image
+ * @return true if the image was transformed, false otherwise
+ */
+using Transform = std::function<bool(const cv::Mat& input, cv::Mat& output)>;
+
+/**
+ * @brief Creates the transformation of an image to grayscale
+ *
+ * @return Transformation
+ */
+Transform grayscale();
+
+/** @brief Image processed by a pipeline */
+struct ProcessedImage {
+    size_t index = 0;                 ///< Position of the image in its batch
+    ImageResult result;               ///< Outcome, sizes and times of the image
+    std::vector<unsigned char> data;  ///< Processed image, encoded (empty if it failed)
+    DownloadResult download;          ///< Outcome of its download (no URL if not downloaded)
+    std::string format;               ///< Format of the original image (see imageFormat())
+};
+
+/**
+ * @brief Pipeline downloading, transforming and storing batches of images
+ *        within the calling process
+ * @details It is the library counterpart of the program: images are pulled
+ *          from URLs, downloaded by a DownloadEngine (S3 objects and local
+ *          files are read directly, the latter through a memory mapping),
+ *          decoded, transformed, encoded and handed to the caller in memory,
+ *          being also written to an output storage if one is set. Images
+ *          are processed by a pool of threads as soon as they are
+ *          downloaded, while the next ones are still being downloaded.
+ *          Downloads land in a staging directory and are removed once
+ *          processed, unless kept in a local storage of the originals
+ *          (see Builder::originals()). By default, each pipeline creates a private one (see
+ *          mkdtemp()) in the temporary directory and removes it when
+ *          destroyed.
+ *          Pipelines are created by a Builder:
+ *          auto pipeline = Pipeline::Builder().threads(4).output(makeStorage("out/")).build();
+ *          pipeline->process(urls, [](ProcessedImage&& image) { ... });
+ *          A pipeline can run several batches at once, from any thread
+ */
+class Pipeline {
+public:
+    /**
+     * @brief Function receiving each processed image, on a thread of the
+     *        pipeline, in the order they finish; it must be thread-safe
+     */
+    using Callback = std::function<void(ProcessedImage&& image)>;
+
+    /** @brief Builder of pipelines */
+    class Builder {
+    public:
+        Builder();
+
+        /**
+         * @brief Sets the source of the URLs processed by run()
+         *
+         * @param source URL source
+         * @return This builder
+         */
+        Builder& source(std::unique_ptr<UrlSource> source);
+
+        /**
+         * @brief Appends a transformation, applied after the previous ones
+         *        (grayscale() if none is appended)
+         *
+         * @param transform Transformation
+         * @return This builder
+         */
+        Builder& transform(Transform transform);
+
+        /**
+         * @brief Sets the format the processed images are encoded into
+         * @details build() fails if OpenCV has no encoder for it
+         *
+         * @param extension Extension of the format (e.g., .png)
+         * @return This builder
+         */
+        Builder& format(const std::string& extension);
+
+        /**
+         * @brief Sets a storage the processed images are also written to,
+         *        under the key INDEX.EXTENSION (INDEX starting at 1)
+         *
+         * @param storage Storage
+         * @return This builder
+         */
+        Builder& output(std::unique_ptr<Storage> storage);
+
+        /**
+         * @brief Sets a storage the downloaded images are kept in, under the
+         *        key INDEX.jpg (see PIPELINE_ORIGINALS_FORMAT)
+         * @details Images are downloaded directly into a local storage, and
+         *          into the staging directory before being written to a
+         *          remote one
+         *
+         * @param storage Storage
+         * @return This builder
+         */
+        Builder& originals(std::unique_ptr<Storage> storage);
+
+        /**
+         * @brief Sets the directory where downloads land before being processed
+         * @details It must only be writable by the user running the pipeline;
+         *          by default, a private directory is created
+         *
+         * @param dir Directory (empty for a private one)
+         * @param keep Whether the downloaded images are kept once processed
+         *        (along with the private directory, if any)
+         * @return This builder
+         */
+        Builder& downloads(const std::string& dir, bool keep = false);
+
+        /**
+         * @brief Sets the settings of the download engine (e.g., the
+         *        maximum concurrent downloads)
+         *
+         * @param options Settings
+         * @return This builder
+         */
+        Builder& downloadOptions(const DownloadEngine::Options& options);
+
+        /**
+         * @brief Sets the number of threads processing images
+         *
+         * @param threads Number of threads (the number of cores by default)
+         * @return This builder
+         */
+        Builder& threads(size_t threads);
+
+        /**
+         * @brief Sets the progress the stages of the images are reported to
+         * @details The progress must be stopped before the pipeline is
+         *          destroyed, as it reads the downloads in flight
+         *
+         * @param progress Progress
+         * @return This builder
+         */
+        Builder& progress(Progress* progress);
+
+        /**
+         * @brief Creates the pipeline, after which the builder must not be used
+         *
+         * @return Pipeline, or nullptr if OpenCV has no encoder for its format
+         *         or its staging directory could not be created
+         */
+        std::unique_ptr<Pipeline> build();
+
+    private:
+        std::unique_ptr<Pipeline> pipeline_;  ///< Pipeline being built
+        std::string downloads_;               ///< Staging directory, if set
+    };
+
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * @brief Processes a batch of images
+     * @details It returns once every image was processed
+     *
+     * @param urls URLs (or local paths) of the images
+     * @param callback Function receiving each processed image
+     */
+    void process(const std::vector<std::string>& urls, Callback callback);
+
+    /**
+     * @brief Processes a batch of images in background
+     * @details The pipeline must outlive the future
+     *
+     * @param urls URLs (or local paths) of the images
+     * @return Future holding the processed images, in the order of the URLs
+     */
+    std::future<std::vector<ProcessedImage>> submit(std::vector<std::string> urls);
+
+    /**
+     * @brief Processes images whose URLs are pulled from the source
+     * @details The next URLs are prefetched while the images are processed
+     *
+     * @param count Number of images
+     * @param callback Function receiving each processed image
+     * @return Number of images pulled (fewer than count if the source ran out)
+     */
+    size_t run(size_t count, Callback callback);
+
+    /**
+     * @brief Processes an encoded image held in memory
+     *
+     * @param data Encoded image
+     * @param size Size of the encoded image
+     * @param id Number of the image, passed to the tracepoints
+     * @return Processed image
+     */
+    ProcessedImage convert(const unsigned char* data, size_t size, uint64_t id = 0) const;
+
+    /**
+     * @brief Applies the transformations to a decoded image
+     * @details The last transformation writes into output, so that a
+     *          buffer it already holds with the right size and type is
+     *          written in place
+     *
+     * @param input Image to transform
+     * @param output Transformed image
+     * @return true if the image was transformed, false otherwise
+     */
+    bool apply(const cv::Mat& input, cv::Mat& output) const;
+
+    /**
+     * @brief Retrieves the queue and latency metrics of each host of the last
+     *        batch whose downloads finished
+     *
+     * @return Metrics of each host, in the order the hosts were first seen
+     */
+    std::vector<HostMetrics> hostMetrics() const;
+
+private:
+    /** @brief Function returning the next URLs of a batch, or none at its end */
+    using Feed = std::function<std::vector<std::string>()>;
+
+    struct Job;
+
+    Pipeline();
+
+    void execute(const Feed& feed, const Callback& callback);
+    ProcessedImage processJob(Job& job, const std::string& prefix) const;
+    std::string downloadPath(const std::string& prefix, uint64_t id) const;
+    size_t engineGauge(size_t (DownloadEngine::*gauge)() const) const;
+    bool encode(const unsigned char* data, size_t size, ProcessedImage& image,
+                uint64_t id) const;
+
+    std::unique_ptr<UrlSource> source_;
+    std::vector<Transform> transforms_;
+    std::string format_ = PIPELINE_DEFAULT_FORMAT;
+    std::unique_ptr<Storage> output_;
+    std::unique_ptr<Storage> originals_;
+    std::unique_ptr<LocalStorage> downloads_;  ///< Staging directory, unless downloaded into originals_
+    std::string stagingDir_;  ///< Private staging directory created by the pipeline, if any
+    bool keepDownloads_ = false;
+    DownloadEngine::Options downloadOptions_;
+    size_t threads_;
+    Progress* progress_ = nullptr;
+    std::atomic<uint64_t> batches_{0};  ///< Batches started, naming their downloads
+    mutable std::mutex enginesMutex_;   ///< Guards the members below
+    std::vector<DownloadEngine*> engines_;  ///< Engines of the batches in progress
+    std::vector<HostMetrics> hostMetrics_;  ///< Metrics of the last batch downloaded
+};
+
+#endif
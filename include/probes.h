@@ -0,0 +1,61 @@
+/**
+ * @file	probes.h
+ * @brief	Static tracepoints (USDT probes) at the boundaries of the tasks
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef PROBES_H
+#define PROBES_H
+
+#include <cstdint>
+
+/**
+ * @brief Whether the tracepoints are compiled in
+ * @details They require the <sys/sdt.h> header of SystemTap (e.g., package
+ *          systemtap-sdt-dev) and can be left out with -DNO_PROBES
+ */
+#if !defined(NO_PROBES) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define PROBES_ENABLED 1
+#endif
+#endif
+
+#ifdef PROBES_ENABLED
+
+/**
+ * @brief Marks the start of a task (probe imageprocessing:TASK_start)
+ * @details A probe is a single no-op instruction plus an ELF note naming it
+ *          and locating its arguments, so it costs nothing until a tracer
+ *          (e.g., bpftrace or SystemTap) attaches to it
+ *
+ * @param task Name of the task (gemini, openai, probe, download, decode,
+ *        convert, encode or write)
+ * @param id Number of the image (arg0), or 0 if the task is not tied to one
+ * @param bytes Bytes the task starts with (arg1)
+ */
+#define PROBE_START(task, id, bytes) \
+    DTRACE_PROBE2(imageprocessing, task##_start, (uint64_t)(id), (uint64_t)(bytes))
+
+/**
+ * @brief Marks the end of a task (probe imageprocessing:TASK_done)
+ *
+ * @param task Name of the task
+ * @param id Number of the image (arg0), or 0 if the task is not tied to one
+ * @param bytes Bytes the task produced (arg1)
+ * @param ok Whether the task succeeded (arg2)
+ */
+#define PROBE_DONE(task, id, bytes, ok) \
+    DTRACE_PROBE3(imageprocessing, task##_done, (uint64_t)(id), (uint64_t)(bytes), (int)(ok))
+
+#else
+
+// The arguments are not evaluated, only referenced to keep them used
+#define PROBE_START(task, id, bytes) ((void)sizeof(id), (void)sizeof(bytes))
+#define PROBE_DONE(task, id, bytes, ok) ((void)sizeof(id), (void)sizeof(bytes), (void)sizeof(ok))
+
+#endif
+
+#endif
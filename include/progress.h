@@ -0,0 +1,280 @@
+/**
+ * @file	progress.h
+ * @brief	Live progress, throughput and utilization of the pipeline stages
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef PROGRESS_H
+#define PROGRESS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** @brief Interval (in milliseconds) between two samples of the stage utilization */
+#define PROGRESS_SAMPLE_MS 100
+
+/** @brief Interval (in milliseconds) between two updates of the status line */
+#define PROGRESS_INTERVAL_MS 1000
+
+/** @brief Interval (in milliseconds) between two progress messages, if not on a terminal */
+#define PROGRESS_LOG_INTERVAL_MS 10000
+
+/** @brief Sliding window (in milliseconds) over which rates and utilization are measured */
+#define PROGRESS_WINDOW_MS 10000
+
+/** @brief Stages an image goes through */
+enum class Stage {
+    Source,    ///< Pulling its URL from the URL source
+    Download,  ///< Downloading it
+    Read,      ///< Reading (or mapping) the original image
+    Convert,   ///< Decoding, converting to grayscale and encoding it
+    Upload     ///< Writing the processed image to its storage
+};
+
+/** @brief Number of stages */
+#define STAGE_COUNT 5
+
+/** @brief Load of a pool of workers over a run, measured while it was active */
+struct PoolLoad {
+    Stage first = Stage::Source;  ///< First stage run by the workers of the pool
+    Stage last = Stage::Source;   ///< Last stage run by the workers of the pool
+    uint64_t items = 0;           ///< Items that entered the pool
+    double activeSeconds = 0;     ///< Time with at least one worker busy
+    double saturatedSeconds = 0;  ///< Time with every worker busy
+    double busy = 0;              ///< Mean busy workers while active
+    double workers = 0;           ///< Mean workers while active
+    double queued = 0;            ///< Mean items waiting to enter the pool while active
+    double share[STAGE_COUNT] = {};  ///< Fraction of the busy time spent in each stage
+};
+
+/**
+ * @brief Retrieves the name of a stage (e.g., download)
+ *
+ * @param stage Stage
+ * @return Name of the stage
+ */
+const char* stageName(Stage stage);
+
+/**
+ * @brief Progress of a batch through the stages
+ * @details Stages report their items through lock-free counters, so that
+ *          counting costs a few atomic increments per item. Once started, a
+ *          background thread samples the counters and the busy workers of
+ *          each stage every PROGRESS_SAMPLE_MS and reports, over the last
+ *          PROGRESS_WINDOW_MS, the items per second of each stage, the bytes
+ *          downloaded per second, the fraction of the workers of each stage
+ *          that were busy (the bottleneck being marked with an asterisk) and
+ *          the estimated time to finish. The report is a status line kept
+ *          at the bottom of the terminal, updated every PROGRESS_INTERVAL_MS,
+ *          or a message logged every PROGRESS_LOG_INTERVAL_MS if the
+ *          standard error is not a terminal (or messages are JSON lines).
+ *          The samples are also accumulated over the whole run into the
+ *          load of each pool of workers (see loads())
+ */
+class Progress {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    /** @brief Function reading a gauge (e.g., the busy workers of a stage) */
+    using Gauge = std::function<size_t()>;
+
+    /**
+     * @brief Item of a stage in progress, counted as done when destroyed
+     *        unless it failed
+     */
+    class Scope {
+    public:
+        /**
+         * @brief Starts an item of a stage
+         *
+         * @param progress Progress counting the item
+         * @param stage Stage of the item
+         */
+        Scope(Progress& progress, Stage stage);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+        /**
+         * @brief Sets the number of items actually processed (1 by default)
+         *
+         * @param items Number of items
+         */
+        void setItems(size_t items) { items_ = items; }
+
+        /**
+         * @brief Sets the bytes processed
+         *
+         * @param bytes Bytes processed
+         */
+        void setBytes(uint64_t bytes) { bytes_ = bytes; }
+
+        /** @brief Marks the item as failed */
+        void fail() { failed_ = true; }
+
+        /** @brief Time (in seconds) elapsed since the item started */
+        double seconds() const {
+            return std::chrono::duration<double>(Clock::now() - start_).count();
+        }
+
+    private:
+        Progress& progress_;
+        Stage stage_;
+        Clock::time_point start_ = Clock::now();
+        size_t items_ = 1;
+        uint64_t bytes_ = 0;
+        bool failed_ = false;
+    };
+
+    /**
+     * @brief Creates the progress of a batch
+     *
+     * @param total Number of items of the batch
+     */
+    explicit Progress(size_t total);
+    ~Progress();
+
+    Progress(const Progress&) = delete;
+    Progress& operator=(const Progress&) = delete;
+
+    /**
+     * @brief Sets the number of workers of a stage (1 by default), whose
+     *        busy workers are the items in progress
+     *
+     * @param stage Stage
+     * @param workers Number of workers
+     */
+    void setWorkers(Stage stage, size_t workers);
+
+    /**
+     * @brief Sets the gauges of the busy and total workers of a stage whose
+     *        items are not reported through Scope (e.g., downloads)
+     * @details The gauges are read by the background thread
+     *
+     * @param stage Stage
+     * @param busy Gauge of the busy workers
+     * @param workers Gauge of the total workers
+     */
+    void setPool(Stage stage, Gauge busy, Gauge workers);
+
+    /**
+     * @brief Declares that the stages from first to last are run one after
+     *        the other by the same workers (e.g., a single thread), whose
+     *        number is that of the first stage
+     *
+     * @param first First stage
+     * @param last Last stage
+     */
+    void shareWorkers(Stage first, Stage last);
+
+    /**
+     * @brief Counts a finished item of a stage
+     *
+     * @param stage Stage
+     * @param ok Whether the item succeeded
+     * @param bytes Bytes processed
+     */
+    void add(Stage stage, bool ok, uint64_t bytes = 0);
+
+    /**
+     * @brief Counts items of the batch that skip a stage (e.g., local
+     *        images are not downloaded)
+     *
+     * @param stage Stage
+     * @param items Number of items
+     */
+    void skip(Stage stage, size_t items = 1);
+
+    /**
+     * @brief Starts sampling the stages
+     *
+     * @param reporting Whether the progress is also reported
+     */
+    void start(bool reporting = true);
+
+    /** @brief Stops sampling the stages, logging a last report if reporting */
+    void stop();
+
+    /**
+     * @brief Retrieves the load of each pool of workers over the samples so far
+     *
+     * @return Load of each pool that had items (with no active time if
+     *         it was never seen busy)
+     */
+    std::vector<PoolLoad> loads();
+
+    /** @brief Time (in seconds) covered by the samples so far */
+    double sampledSeconds();
+
+    /**
+     * @brief Builds a report of the progress so far
+     *
+     * @return Report, in a single line
+     */
+    std::string report();
+
+private:
+    /** @brief Counters of a stage */
+    struct Counters {
+        std::atomic<uint64_t> done{0};     ///< Items done
+        std::atomic<uint64_t> failed{0};   ///< Items failed
+        std::atomic<uint64_t> skipped{0};  ///< Items not going through the stage
+        std::atomic<uint64_t> bytes{0};    ///< Bytes processed
+        std::atomic<size_t> active{0};     ///< Items in progress
+        std::atomic<size_t> workers{1};    ///< Workers of the stage
+        Gauge busyGauge;                   ///< Busy workers, if not active
+        Gauge workersGauge;                ///< Total workers, if not workers
+    };
+
+    /** @brief Snapshot of the counters */
+    struct Sample {
+        Clock::time_point time;
+        uint64_t done[STAGE_COUNT];
+        uint64_t bytes[STAGE_COUNT];
+        double busy[STAGE_COUNT];      ///< Fraction of the workers busy
+        size_t active[STAGE_COUNT];    ///< Busy workers
+        size_t workers[STAGE_COUNT];   ///< Total workers
+        uint64_t queued[STAGE_COUNT];  ///< Items waiting for the stage
+    };
+
+    /** @brief Sums of the samples over the run, weighted by their interval */
+    struct Totals {
+        double active = 0;     ///< Seconds with a worker of the pool busy
+        double saturated = 0;  ///< Seconds with every worker of the pool busy
+        double busy = 0;       ///< Busy worker-seconds of the pool, while active
+        double workers = 0;    ///< Worker-seconds of the pool, while active
+        double queued = 0;     ///< Item-seconds waiting for the pool, while active
+        double stageBusy = 0;  ///< Busy worker-seconds of the stage itself
+    };
+
+    void run();
+    Sample sample();
+    void accumulate(const Sample& sample, double seconds);
+
+    size_t total_;
+    Counters stages_[STAGE_COUNT];
+    int pools_[STAGE_COUNT];       ///< First stage of the pool running each stage
+    Clock::time_point started_;
+    bool reporting_ = true;
+    std::mutex samplesMutex_;      ///< Guards the members below
+    std::deque<Sample> samples_;   ///< Samples within the window
+    Totals totals_[STAGE_COUNT];   ///< Totals of each stage (and pool, if first)
+    double sampledSeconds_ = 0;    ///< Time covered by the samples
+    std::mutex stopMutex_;         ///< Guards stop_
+    std::condition_variable stopped_;
+    bool stop_ = false;
+    std::thread reporter_;
+};
+
+#endif
@@ -0,0 +1,73 @@
+/**
+ * @file	results.h
+ * @brief	Stream of the results of each image, as JSON lines
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef RESULTS_H
+#define RESULTS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+
+#include "progress.h"
+
+/** @brief Result of processing an image */
+struct ImageResult {
+    std::string url;            ///< URL (or path) of the original image
+    std::string output;         ///< Location of the processed image, written if ok
+    bool ok = false;            ///< Whether the image was processed and stored
+    std::string error;          ///< Reason of the failure, if any
+    std::string sha256;         ///< SHA-256 digest of the processed image, in hexadecimal
+    int width = 0;              ///< Width of the image, in pixels
+    int height = 0;             ///< Height of the image, in pixels
+    uint64_t inputBytes = 0;    ///< Size of the original image
+    uint64_t outputBytes = 0;   ///< Size of the processed image
+    double wait = -1;           ///< Time (in seconds) queued for download, if downloaded
+    double seconds[STAGE_COUNT] = {-1, -1, -1, -1, -1};  ///< Time in each stage, if any
+};
+
+/**
+ * @brief Stream of the results of each image, written as soon as the image
+ *        is done
+ * @details Each result is written as a JSON object in a line of its own
+ *          (NDJSON) and flushed right away, so that other programs can
+ *          consume the results while the batch runs (e.g., tail -f). Stages
+ *          the image did not go through are left out of its timings
+ */
+class ResultStream {
+public:
+    /**
+     * @brief Opens the stream
+     *
+     * @param path File receiving the results (truncated), or - for the
+     *        standard output
+     */
+    explicit ResultStream(const std::string& path);
+    ~ResultStream();
+
+    ResultStream(const ResultStream&) = delete;
+    ResultStream& operator=(const ResultStream&) = delete;
+
+    /** @brief Whether the stream was opened */
+    bool valid() const { return file_ != nullptr; }
+
+    /**
+     * @brief Writes the result of an image
+     * @details It can be called from any thread
+     *
+     * @param result Result of the image
+     */
+    void write(const ImageResult& result);
+
+private:
+    FILE* file_;
+    bool owned_;         ///< Whether file_ must be closed
+    std::mutex mutex_;   ///< Serializes the writes
+};
+
+#endif
@@ -0,0 +1,97 @@
+/**
+ * @file	slowlog.h
+ * @brief	Log of the images whose stages were outliers, with diagnostics
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef SLOWLOG_H
+#define SLOWLOG_H
+
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "download.h"
+#include "progress.h"
+#include "results.h"
+
+/** @brief Multiple of the running 99th percentile above which a stage is slow */
+#define SLOW_LOG_FACTOR 3.0
+
+/** @brief Number of latest times of each stage the running 99th percentile is computed on */
+#define SLOW_LOG_WINDOW 1000
+
+/** @brief Number of times of a stage needed before its outliers are logged */
+#define SLOW_LOG_MIN_SAMPLES 50
+
+/**
+ * @brief Log of the images that spent much longer than usual in a stage
+ * @details The time of each image in each stage is compared with the 99th
+ *          percentile of the last SLOW_LOG_WINDOW times of the stage (once
+ *          there are SLOW_LOG_MIN_SAMPLES of them). Images exceeding the
+ *          percentile by a given factor in any stage are written to the log
+ *          as a JSON object per line, with everything known about them: the
+ *          slow stages and their thresholds, the time in each stage, the
+ *          sizes, dimensions and format of the image and, if downloaded, the
+ *          timing breakdown of its requests (name lookup, connection, TLS
+ *          handshake, first byte), their HTTP status and version, the
+ *          number of attempts and the response headers
+ */
+class SlowLog {
+public:
+    /**
+     * @brief Opens the log
+     *
+     * @param path File receiving the log (truncated)
+     * @param factor Multiple of the 99th percentile above which a stage is slow
+     */
+    explicit SlowLog(const std::string& path, double factor = SLOW_LOG_FACTOR);
+    ~SlowLog();
+
+    SlowLog(const SlowLog&) = delete;
+    SlowLog& operator=(const SlowLog&) = delete;
+
+    /** @brief Whether the log was opened */
+    bool valid() const { return file_ != nullptr; }
+
+    /**
+     * @brief Accounts the times of an image, logging it if it was slow
+     * @details It can be called from any thread
+     *
+     * @param result Result of the image
+     * @param download Outcome of its download, or nullptr if not downloaded
+     * @param format Format of the original image (see imageFormat()), or an
+     *        empty string if unknown
+     * @return true if the image was slow, false otherwise
+     */
+    bool observe(const ImageResult& result, const DownloadResult* download,
+                 const std::string& format);
+
+private:
+    /** @brief Latest times of a stage */
+    struct Window {
+        std::vector<double> times;  ///< Ring of up to SLOW_LOG_WINDOW times
+        size_t next = 0;            ///< Next position of the ring to write
+    };
+
+    double percentile(const Window& window) const;
+
+    FILE* file_;
+    double factor_;
+    std::mutex mutex_;                  ///< Guards the members below
+    Window windows_[STAGE_COUNT];
+};
+
+/**
+ * @brief Recognizes the format of an encoded image from its signature
+ *
+ * @param data Encoded image
+ * @param size Size of the encoded image
+ * @return Format (e.g., jpeg or png), or an empty string if unknown
+ */
+std::string imageFormat(const unsigned char* data, size_t size);
+
+#endif
@@ -0,0 +1,195 @@
+/**
+ * @file	storage.h
+ * @brief	Storage backends for the original and processed images
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include <curl/curl.h>
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/** @brief Size (in bytes) of each part of a multipart upload or ranged download */
+#define S3_PART_SIZE (8L * 1024 * 1024)
+
+/** @brief Maximum number of parts transferred at the same time */
+#define S3_MAX_PARALLEL 8
+
+/** @brief Default S3 endpoint, if AWS_ENDPOINT_URL is not set */
+#define S3_DEFAULT_ENDPOINT "https://s3.amazonaws.com"
+
+/** @brief Default S3 region, if AWS_REGION is not set */
+#define S3_DEFAULT_REGION "us-east-1"
+
+/**
+ * @brief Storage of images, addressed by key (e.g., 1.jpg)
+ * @details Implementations must be usable from several threads at once
+ */
+class Storage {
+public:
+    virtual ~Storage() = default;
+
+    /** @brief Name of the storage, for messages */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Reads an object
+     *
+     * @param key Key of the object
+     * @param data Contents of the object
+     * @return true if the object was read, false otherwise
+     */
+    virtual bool get(const std::string& key, std::vector<unsigned char>& data) = 0;
+
+    /**
+     * @brief Writes an object, replacing it if it exists
+     *
+     * @param key Key of the object
+     * @param data Contents of the object
+     * @param size Size of the contents
+     * @return true if the object was written, false otherwise
+     */
+    virtual bool put(const std::string& key, const unsigned char* data, size_t size) = 0;
+
+    /**
+     * @brief Retrieves the local file holding an object, so that it can be
+     *        written in place (e.g., by a download)
+     *
+     * @param key Key of the object
+     * @return Path to the file, or an empty string if the storage is remote
+     */
+    virtual std::string localPath(const std::string& key) const;
+};
+
+/** @brief Storage of images as files in a local directory */
+class LocalStorage final : public Storage {
+public:
+    /**
+     * @brief Creates the storage, creating the directory if needed
+     *
+     * @param dir Directory
+     */
+    explicit LocalStorage(const std::string& dir);
+
+    std::string name() const override;
+    bool get(const std::string& key, std::vector<unsigned char>& data) override;
+    bool put(const std::string& key, const unsigned char* data, size_t size) override;
+    std::string localPath(const std::string& key) const override;
+
+private:
+    std::string dir_;  ///< Directory, ending with a slash
+};
+
+/**
+ * @brief Storage of images in a bucket of an S3-compatible object storage
+ *        (e.g., Amazon S3 or MinIO)
+ * @details Requests are signed with AWS Signature Version 4 by libcurl and
+ *          use path-style addressing (endpoint/bucket/key). All requests of
+ *          the storage share a pool of connections (and their TLS sessions
+ *          and resolved host names) through a libcurl share handle, whatever
+ *          the thread issuing them. Objects larger than S3_PART_SIZE are
+ *          uploaded as multipart uploads and downloaded as range requests,
+ *          transferring up to S3_MAX_PARALLEL parts at the same time
+ */
+class S3Storage final : public Storage {
+public:
+    /** @brief Settings of the storage */
+    struct Options {
+        std::string endpoint = S3_DEFAULT_ENDPOINT;  ///< Endpoint URL
+        std::string region = S3_DEFAULT_REGION;      ///< Region signing the requests
+        std::string accessKey;                       ///< Access key ID
+        std::string secretKey;                       ///< Secret access key
+        std::string bucket;                          ///< Bucket
+        std::string prefix;                          ///< Prefix prepended to the keys
+    };
+
+    /**
+     * @brief Creates the storage
+     *
+     * @param options Settings of the storage
+     */
+    explicit S3Storage(const Options& options);
+    ~S3Storage() override;
+
+    S3Storage(const S3Storage&) = delete;
+    S3Storage& operator=(const S3Storage&) = delete;
+
+    std::string name() const override;
+    bool get(const std::string& key, std::vector<unsigned char>& data) override;
+    bool put(const std::string& key, const unsigned char* data, size_t size) override;
+
+private:
+    struct Transfer;
+
+    std::unique_ptr<Transfer> prepare(const char* method, const std::string& key,
+                                      const std::string& query = "");
+    bool run(std::vector<std::unique_ptr<Transfer>>& transfers);
+    bool putMultipart(const std::string& key, const unsigned char* data, size_t size);
+
+    static void lock(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlock(CURL* curl, curl_lock_data data, void* userp);
+
+    Options options_;
+    std::string credentials_;                ///< accessKey:secretKey
+    std::string sigv4_;                      ///< Provider, region and service signed
+    CURLSH* share_;                          ///< Share handle holding the connections
+    std::mutex locks_[CURL_LOCK_DATA_LAST];  ///< Lock of each shared data
+};
+
+/**
+ * @brief Creates a storage from its specification
+ * @details The specification is either a local directory or
+ *          s3://BUCKET[/PREFIX]. For the latter, the endpoint, region and
+ *          credentials are read from the AWS_ENDPOINT_URL, AWS_REGION,
+ *          AWS_ACCESS_KEY_ID and AWS_SECRET_ACCESS_KEY environment variables
+ *
+ * @param spec Specification of the storage
+ * @return Storage, or nullptr if the specification is invalid
+ */
+std::unique_ptr<Storage> makeStorage(const std::string& spec);
+
+/**
+ * @brief Checks whether a URL refers to an object of an S3 bucket (s3://BUCKET/KEY)
+ *
+ * @param url URL
+ * @return true if the URL refers to an S3 object, false otherwise
+ */
+bool isS3Url(const std::string& url);
+
+/**
+ * @brief Reads an object of an S3 bucket from its URL (s3://BUCKET/KEY)
+ * @details The storage of each bucket is created once, as done by
+ *          makeStorage(), and kept until releaseS3Storages()
+ *
+ * @param url URL of the object
+ * @param data Contents of the object
+ * @return true if the object was read, false otherwise
+ */
+bool readS3Url(const std::string& url, std::vector<unsigned char>& data);
+
+/**
+ * @brief Releases the storages of the buckets read by readS3Url()
+ * @details They hold libcurl handles, so it must be called before
+ *          curl_global_cleanup(); reads in progress keep their storage
+ *          until they finish, and later reads create it again
+ */
+void releaseS3Storages();
+
+/**
+ * @brief Computes the SHA-256 digest of data (e.g., for the
+ *        x-amz-content-sha256 header of S3 requests)
+ *
+ * @param data Data
+ * @param size Size of the data
+ * @return Digest, in hexadecimal
+ */
+std::string sha256(const unsigned char* data, size_t size);
+
+#endif
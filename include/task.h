@@ -0,0 +1,68 @@
+/**
+ * @file	task.h
+ * @brief	Tag of the task each thread is working on
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef TASK_H
+#define TASK_H
+
+/**
+ * @brief Task a thread is working on, finer than the stages of the pipeline
+ * @details Instrumentation (e.g., the profiler) attributes what a thread
+ *          does to its current task
+ */
+enum class Task {
+    None,      ///< No task (e.g., waiting or bookkeeping)
+    Gemini,    ///< Requesting URLs from Google Gemini
+    OpenAi,    ///< Requesting URLs from an OpenAI-compatible API
+    Crawl,     ///< Crawling HTML pages for URLs
+    Probe,     ///< Checking whether a URL is accessible
+    Download,  ///< Downloading images
+    Read,      ///< Reading (or mapping) an original image
+    Decode,    ///< Decoding an image
+    Convert,   ///< Converting an image to grayscale
+    Encode,    ///< Encoding a processed image
+    Write      ///< Writing an image to its storage
+};
+
+/** @brief Number of tasks */
+#define TASK_COUNT 11
+
+/**
+ * @brief Retrieves the name of a task (e.g., decode)
+ *
+ * @param task Task
+ * @return Name of the task
+ */
+const char* taskName(Task task);
+
+/**
+ * @brief Retrieves the task of the calling thread
+ * @details It is async-signal-safe
+ *
+ * @return Current task
+ */
+Task currentTask();
+
+/** @brief Sets the task of the calling thread while in scope, restoring the previous one */
+class TaskScope {
+public:
+    /**
+     * @brief Starts a task
+     *
+     * @param task Task
+     */
+    explicit TaskScope(Task task);
+    ~TaskScope();
+
+    TaskScope(const TaskScope&) = delete;
+    TaskScope& operator=(const TaskScope&) = delete;
+
+private:
+    Task previous_;
+};
+
+#endif
@@ -0,0 +1,81 @@
+/**
+ * @file	tlscache.h
+ * @brief	Cache of TLS sessions shared by all HTTPS requests and persisted
+ *          between runs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef TLSCACHE_H
+#define TLSCACHE_H
+
+#include <curl/curl.h>
+
+#include <mutex>
+#include <string>
+
+/**
+ * @brief Cache of TLS sessions shared by all HTTPS requests
+ * @details All easy handles share their TLS sessions (tickets) through a
+ *          libcurl share handle, so that a connection to a host already
+ *          contacted resumes the session (1-RTT) instead of doing a full
+ *          handshake. Idempotent requests may also send early data (0-RTT)
+ *          when the TLS backend supports it. With libcurl 8.12 or later,
+ *          the sessions are exported to a file at the end of a run and
+ *          imported at the start of the next one, skipping expired ones;
+ *          with older versions, they are only shared within a run
+ */
+class TlsSessionCache {
+public:
+    /** @brief Cache shared by the whole process */
+    static TlsSessionCache& instance();
+
+    ~TlsSessionCache();
+
+    /**
+     * @brief Makes an easy handle use the shared TLS sessions
+     *
+     * @param curl Easy handle to configure
+     * @param earlyData Whether the request is idempotent and can be sent
+     *        as TLS early data (0-RTT), which a network attacker can replay
+     */
+    void apply(CURL* curl, bool earlyData);
+
+    /**
+     * @brief Imports the sessions persisted by an earlier run
+     *
+     * @param filename Cache file
+     */
+    void load(const std::string& filename);
+
+    /**
+     * @brief Persists the sessions that did not expire
+     * @details The file holds session secrets, so only its owner can read it
+     *
+     * @param filename Cache file
+     */
+    void save(const std::string& filename);
+
+    /**
+     * @brief Releases the share handle and its sessions, unless an easy
+     *        handle still uses it
+     * @details It must be called before curl_global_cleanup(); a later
+     *          request creates a new share handle
+     */
+    void release();
+
+private:
+    TlsSessionCache();
+
+    static void lock(CURL* curl, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlock(CURL* curl, curl_lock_data data, void* userp);
+
+    CURLSH* share();
+
+    CURLSH* share_ = nullptr;                ///< Share handle holding the sessions, if created
+    std::mutex shareMutex_;                  ///< Guards share_
+    std::mutex locks_[CURL_LOCK_DATA_LAST];  ///< Lock of each shared data
+};
+
+#endif
@@ -0,0 +1,286 @@
+/**
+ * @file	urlsource.h
+ * @brief	Sources of the URLs of the images to process
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef URLSOURCE_H
+#define URLSOURCE_H
+
+#include <fstream>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <vector>
+
+/** @brief Number of URLs pulled from a source at a time */
+#define URL_SOURCE_BATCH 16
+
+/** @brief Maximum rounds of prompts a source asking a model runs per batch */
+#define URL_SOURCE_MAX_ROUNDS 5
+
+/** @brief Default URL source */
+#define URL_SOURCE_DEFAULT "gemini"
+
+/**
+ * @brief Check if a URL is accessible by making an HTTP request to it
+ *
+ * @param url URL to check
+ * @return true if the request is successful, false otherwise
+ */
+bool isAccessible(const std::string& url);
+
+/**
+ * @brief Checks whether a URL has a scheme images are read from (http://,
+ *        https://, s3:// or file://)
+ *
+ * @param url URL
+ * @return true if the scheme is supported, false otherwise
+ */
+bool isInputUrl(const std::string& url);
+
+/**
+ * @brief Source of image URLs
+ * @details URLs are pulled in batches. A batch can be pulled in background
+ *          (pullAsync()) or prefetched, so that the next pull() returns it
+ *          at once while the previous batch is being downloaded. Pulls are
+ *          serialized, so a source needs no synchronization of its own.
+ *          Implementations override produce() and must call drain() in
+ *          their destructor, so that no prefetch outlives them. URLs
+ *          produced without a supported scheme (see isInputUrl()) are
+ *          dropped, unless the source lists local paths and they are
+ *          explicit ones (see localPathOf()). Futures
+ *          returned by pullAsync() must be waited for before the source is
+ *          destroyed
+ */
+class UrlSource {
+public:
+    virtual ~UrlSource() = default;
+
+    /** @brief Name of the source, for messages */
+    virtual std::string name() const = 0;
+
+    /**
+     * @brief Pulls the next URLs, blocking until they are available
+     *
+     * @param count Number of URLs wanted
+     * @return Up to count URLs; fewer (or none) once the source is exhausted
+     */
+    std::vector<std::string> pull(size_t count);
+
+    /**
+     * @brief Pulls the next URLs in background
+     *
+     * @param count Number of URLs wanted
+     * @return Future holding the URLs, as returned by pull()
+     */
+    std::future<std::vector<std::string>> pullAsync(size_t count);
+
+    /**
+     * @brief Starts pulling the next URLs in background, so that the next
+     *        pull() returns them without waiting (if they are ready)
+     *
+     * @param count Number of URLs wanted
+     */
+    void prefetch(size_t count);
+
+protected:
+    /**
+     * @brief Produces the next URLs
+     *
+     * @param count Number of URLs wanted
+     * @return Up to count URLs; fewer (or none) once the source is exhausted
+     */
+    virtual std::vector<std::string> produce(size_t count) = 0;
+
+    /** @brief Waits for the prefetched pull, if any */
+    void drain();
+
+    /**
+     * @brief Whether the URLs produced may be local paths, which only
+     *        sources written by the user (e.g., a manifest) can be trusted with
+     */
+    virtual bool listsPaths() const { return false; }
+
+private:
+    std::vector<std::string> produceChecked(size_t count);
+
+    std::mutex mutex_;                                ///< Serializes produce()
+    std::mutex prefetchMutex_;                        ///< Guards the members below
+    std::future<std::vector<std::string>> prefetched_;  ///< Prefetch in progress
+    std::vector<std::string> pending_;                ///< Prefetched, not yet pulled
+};
+
+/**
+ * @brief Source asking a large language model to generate image URLs
+ * @details URLs are generated in a two-step process with two prompts. The
+ *          first one generates URLs directly pointing to a valid image file
+ *          in either JPEG or PNG format, sampling several candidate
+ *          responses at once. The second one extracts only the list of URLs
+ *          from the output of all candidates, as there is no guarantee that
+ *          the first prompt generates only the list of image URLs. Only
+ *          accessible http:// and https:// URLs not seen before are returned, and rounds are
+ *          repeated until enough URLs are found, for at most
+ *          URL_SOURCE_MAX_ROUNDS rounds. A round yielding no new URL (e.g.,
+ *          the model is unreachable or only repeats itself) ends the batch,
+ *          which then has fewer URLs
+ */
+class PromptUrlSource : public UrlSource {
+protected:
+    /**
+     * @brief Creates the source
+     *
+     * @param candidates Number of candidate responses sampled by each
+     *        generation prompt, if the model supports more than one
+     */
+    explicit PromptUrlSource(int candidates = 1) : candidates_(candidates) {}
+
+    /**
+     * @brief Executes a prompt on the model
+     *
+     * @param prompt Prompt to be executed
+     * @param candidates Number of candidate responses to be sampled
+     * @return Text of each candidate response
+     */
+    virtual std::vector<std::string> complete(const std::string& prompt,
+                                              int candidates) = 0;
+
+    std::vector<std::string> produce(size_t count) override;
+
+private:
+    int candidates_;              ///< Candidate responses sampled by each generation prompt
+    std::set<std::string> seen_;  ///< URLs already checked
+};
+
+/**
+ * @brief Source asking Google Gemini to generate image URLs
+ * @details Each generation prompt samples GEMINI_CANDIDATE_COUNT candidates
+ */
+class GeminiUrlSource final : public PromptUrlSource {
+public:
+    /**
+     * @brief Creates the source
+     *
+     * @param apiKey API key to Google Gemini
+     */
+    explicit GeminiUrlSource(const std::string& apiKey);
+    ~GeminiUrlSource() override;
+
+    std::string name() const override;
+
+protected:
+    std::vector<std::string> complete(const std::string& prompt, int candidates) override;
+
+private:
+    std::string apiKey_;
+};
+
+/**
+ * @brief Source asking a model served by an OpenAI-compatible endpoint (e.g.,
+ *        a llama.cpp server on localhost) to generate image URLs
+ * @details Each generation prompt samples OPENAI_CHOICE_COUNT choices
+ */
+class OpenAiUrlSource final : public PromptUrlSource {
+public:
+    /**
+     * @brief Creates the source
+     *
+     * @param baseUrl Base URL of the API (e.g., http://localhost:8080/v1)
+     * @param model Model to be used
+     * @param apiKey API key sent as a bearer token (none if empty)
+     */
+    OpenAiUrlSource(const std::string& baseUrl, const std::string& model,
+                    const std::string& apiKey);
+    ~OpenAiUrlSource() override;
+
+    std::string name() const override;
+
+protected:
+    std::vector<std::string> complete(const std::string& prompt, int candidates) override;
+
+private:
+    std::string baseUrl_;
+    std::string model_;
+    std::string apiKey_;
+};
+
+/**
+ * @brief Source reading image URLs from a manifest file
+ * @details The file has one URL per line. Blank lines and lines starting
+ *          with # are ignored. URLs are not checked
+ */
+class ManifestUrlSource final : public UrlSource {
+public:
+    /**
+     * @brief Creates the source
+     *
+     * @param filename Manifest file
+     */
+    explicit ManifestUrlSource(const std::string& filename);
+    ~ManifestUrlSource() override;
+
+    std::string name() const override;
+
+protected:
+    std::vector<std::string> produce(size_t count) override;
+    bool listsPaths() const override { return true; }
+
+private:
+    std::string filename_;
+    std::ifstream file_;
+};
+
+/**
+ * @brief Source generating deterministic image URLs
+ * @details The i-th URL is baseUrl/i.jpg (i starting at 1). It is meant for
+ *          running and benchmarking the pipeline against a local server,
+ *          with no external service involved
+ */
+class FakeUrlSource final : public UrlSource {
+public:
+    /**
+     * @brief Creates the source
+     *
+     * @param baseUrl Base URL of the images
+     * @param limit Number of URLs before the source is exhausted (0 for none)
+     */
+    explicit FakeUrlSource(const std::string& baseUrl, size_t limit = 0);
+    ~FakeUrlSource() override;
+
+    std::string name() const override;
+
+protected:
+    std::vector<std::string> produce(size_t count) override;
+
+private:
+    std::string baseUrl_;
+    size_t limit_;
+    size_t next_ = 1;
+};
+
+/**
+ * @brief Creates a URL source from its specification
+ * @details The specification is one of:
+ *          - gemini: Google Gemini, with the API key given
+ *          - openai[=URL[#MODEL]]: an OpenAI-compatible endpoint (by default,
+ *            OPENAI_API_URL and OPENAI_MODEL), with the API key given if any
+ *          - manifest=FILE: a manifest file
+ *          - crawl=URL[#DEPTH]: images found by crawling from the page at
+ *            URL, following links up to DEPTH (by default, CRAWLER_MAX_DEPTH)
+ *            away on the same host
+ *          - fake=URL[#LIMIT]: deterministic URLs under URL
+ *
+ * @param spec Specification of the source
+ * @param geminiKey API key to Google Gemini, used by the gemini source only
+ * @param openAiKey API key to the OpenAI-compatible endpoint, used by the
+ *        openai source only (none if empty)
+ * @return Source, or nullptr if the specification is invalid
+ */
+std::unique_ptr<UrlSource> makeUrlSource(const std::string& spec, const std::string& geminiKey,
+                                         const std::string& openAiKey = "");
+
+#endif
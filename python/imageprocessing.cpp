@@ -0,0 +1,611 @@
+/**
+ * @file	imageprocessing.cpp
+ * @brief	Python bindings of the in-process pipeline (module imageprocessing)
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+// Python.h must come first, as it sets feature macros of the system headers
+#define PY_SSIZE_T_CLEAN
+#include <Python.h>
+
+#include <cstring>
+#include <exception>
+#include <new>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "pipeline.h"
+
+namespace {
+
+/**
+ * @brief Python object holding an image owned by C++ (decoded or encoded)
+ * @details It exposes the image through the buffer protocol, so that
+ *          numpy.asarray() and memoryview() share its memory instead of
+ *          copying it: decoded images as arrays of rows, columns and (if
+ *          more than one) channels of uint8, encoded images as arrays of bytes
+ */
+struct ImageObject {
+    PyObject_HEAD
+    cv::Mat mat;                      ///< Decoded image, if any
+    std::vector<unsigned char> data;  ///< Encoded image, if not decoded
+    int ndim;                         ///< Number of dimensions exported
+    Py_ssize_t shape[3];              ///< Size of each dimension
+    Py_ssize_t strides[3];            ///< Bytes between consecutive items of each dimension
+};
+
+/** @brief Python object wrapping a Pipeline */
+struct PipelineObject {
+    PyObject_HEAD
+    Pipeline* pipeline;  ///< Pipeline, created when the object is initialized
+};
+
+PyTypeObject* imageType = nullptr;     ///< Type imageprocessing.Image
+PyTypeObject* pipelineType = nullptr;  ///< Type imageprocessing.Pipeline
+
+/**
+ * @brief Buffer of a Python object, released when it goes out of scope
+ * @details The exporter keeps its memory in place while the buffer is
+ *          held, so the memory can be used without the GIL; the buffer
+ *          itself must be released with the GIL held
+ */
+class Buffer {
+public:
+    Buffer() = default;
+    ~Buffer() {
+        if (held_) PyBuffer_Release(&view_);
+    }
+
+    Buffer(const Buffer&) = delete;
+    Buffer& operator=(const Buffer&) = delete;
+
+    /**
+     * @brief Requests the buffer of an object
+     *
+     * @param object Object exporting the buffer
+     * @param flags Kind of buffer requested (PyBUF_*)
+     * @return true if the buffer was obtained, false (with an exception set) otherwise
+     */
+    bool get(PyObject* object, int flags) {
+        held_ = PyObject_GetBuffer(object, &view_, flags) == 0;
+        return held_;
+    }
+
+    const Py_buffer& view() const { return view_; }
+
+private:
+    Py_buffer view_;
+    bool held_ = false;
+};
+
+/**
+ * @brief Runs a function without holding the GIL, so that other Python
+ *        threads run meanwhile
+ * @details The function must not touch Python objects. Exceptions it throws
+ *          (e.g., cv::Exception) are raised as RuntimeError once the GIL is
+ *          taken back
+ *
+ * @param function Function
+ * @return true if the function completed, false (with an exception set) otherwise
+ */
+template <typename Function>
+bool withoutGil(Function&& function) {
+    bool failed = false;
+    std::string error;
+    Py_BEGIN_ALLOW_THREADS
+    try {
+        function();
+    } catch (const std::exception& e) {
+        failed = true;
+        error = e.what();
+    }
+    Py_END_ALLOW_THREADS
+    if (failed) PyErr_SetString(PyExc_RuntimeError, error.c_str());
+    return !failed;
+}
+
+/**
+ * @brief Creates an image object, with no image yet
+ *
+ * @return Image object, or nullptr (with an exception set) if it could not be allocated
+ */
+ImageObject* allocateImage() {
+    ImageObject* self = PyObject_New(ImageObject, imageType);
+    if (!self) return nullptr;
+    new (&self->mat) cv::Mat();
+    new (&self->data) std::vector<unsigned char>();
+    return self;
+}
+
+/**
+ * @brief Wraps a decoded image into an image object, without copying its pixels
+ *
+ * @param mat Image
+ * @return Image object, or nullptr (with an exception set)
+ */
+PyObject* wrapImage(cv::Mat&& mat) {
+    ImageObject* self = allocateImage();
+    if (!self) return nullptr;
+    self->mat = std::move(mat);
+    self->ndim = self->mat.channels() == 1 ? 2 : 3;
+    self->shape[0] = self->mat.rows;
+    self->shape[1] = self->mat.cols;
+    self->shape[2] = self->mat.channels();
+    self->strides[0] = (Py_ssize_t)self->mat.step[0];
+    self->strides[1] = (Py_ssize_t)self->mat.elemSize();
+    self->strides[2] = 1;
+    return (PyObject*)self;
+}
+
+/**
+ * @brief Wraps an encoded image into an image object, without copying it
+ *
+ * @param data Encoded image
+ * @return Image object, or nullptr (with an exception set)
+ */
+PyObject* wrapEncoded(std::vector<unsigned char>&& data) {
+    ImageObject* self = allocateImage();
+    if (!self) return nullptr;
+    self->data = std::move(data);
+    self->ndim = 1;
+    self->shape[0] = (Py_ssize_t)self->data.size();
+    self->strides[0] = 1;
+    return (PyObject*)self;
+}
+
+void imageDealloc(PyObject* object) {
+    ImageObject* self = (ImageObject*)object;
+    PyTypeObject* type = Py_TYPE(object);
+    self->mat.~Mat();
+    self->data.~vector();
+    type->tp_free(object);
+    Py_DECREF(type);
+}
+
+int imageGetBuffer(PyObject* object, Py_buffer* view, int flags) {
+    ImageObject* self = (ImageObject*)object;
+    bool strided = (flags & PyBUF_STRIDES) == PyBUF_STRIDES;
+    if (self->ndim > 1 && !self->mat.isContinuous() && !strided) {
+        // Rows are apart (e.g., a region of a larger image) and need strides
+        PyErr_SetString(PyExc_BufferError, "image is not contiguous");
+        view->obj = nullptr;
+        return -1;
+    }
+    view->buf = self->ndim == 1 ? (void*)self->data.data() : (void*)self->mat.data;
+    Py_INCREF(object);
+    view->obj = object;
+    view->len = 1;
+    for (int i = 0; i < self->ndim; i++) view->len *= self->shape[i];
+    view->readonly = 0;
+    view->itemsize = 1;
+    view->format = (flags & PyBUF_FORMAT) ? (char*)"B" : nullptr;
+    view->ndim = self->ndim;
+    view->shape = (flags & PyBUF_ND) == PyBUF_ND ? self->shape : nullptr;
+    view->strides = strided ? self->strides : nullptr;
+    view->suboffsets = nullptr;
+    view->internal = nullptr;
+    return 0;
+}
+
+PyObject* imageShape(PyObject* object, void*) {
+    ImageObject* self = (ImageObject*)object;
+    PyObject* shape = PyTuple_New(self->ndim);
+    if (!shape) return nullptr;
+    for (int i = 0; i < self->ndim; i++) {
+        PyTuple_SET_ITEM(shape, i, PyLong_FromSsize_t(self->shape[i]));
+    }
+    return shape;
+}
+
+/**
+ * @brief Wraps the buffer of a Python object (e.g., a numpy array) into an
+ *        image, without copying its pixels
+ * @details The buffer must hold uint8 items in rows, columns and optionally
+ *          channels, the pixels of each row being contiguous (rows may be
+ *          apart, e.g., a slice of a larger array)
+ *
+ * @param object Object exporting the buffer
+ * @param writable Whether the image is to be written
+ * @param buffer Buffer of the object, which must outlive the image
+ * @param image Image sharing the memory of the buffer
+ * @return true if the buffer was wrapped, false (with an exception set) otherwise
+ */
+bool wrapBuffer(PyObject* object, bool writable, Buffer& buffer, cv::Mat& image) {
+    if (!buffer.get(object, writable ? PyBUF_RECORDS : PyBUF_RECORDS_RO)) return false;
+    const Py_buffer& view = buffer.view();
+    const char* format = view.format ? view.format : "B";
+    if (*format && strchr("@=<>!", *format)) format++;
+    if (view.itemsize != 1 || strcmp(format, "B") != 0) {
+        PyErr_SetString(PyExc_TypeError, "image must hold uint8 items");
+        return false;
+    }
+    if (view.ndim != 2 && view.ndim != 3) {
+        PyErr_SetString(PyExc_ValueError,
+                        "image must have 2 (rows, columns) or 3 (rows, columns, channels) dimensions");
+        return false;
+    }
+    Py_ssize_t rows = view.shape[0], cols = view.shape[1];
+    Py_ssize_t channels = view.ndim == 3 ? view.shape[2] : 1;
+    if (rows <= 0 || cols <= 0 || channels <= 0 || channels > CV_CN_MAX) {
+        PyErr_SetString(PyExc_ValueError, "image is empty or has too many channels");
+        return false;
+    }
+    if (view.strides[view.ndim - 1] != 1 || (view.ndim == 3 && view.strides[1] != channels) ||
+        view.strides[0] < cols * channels) {
+        PyErr_SetString(PyExc_ValueError,
+                        "pixels of each row of the image must be contiguous (e.g., not a "
+                        "transposed view)");
+        return false;
+    }
+    image = cv::Mat((int)rows, (int)cols, CV_8UC((int)channels), view.buf, (size_t)view.strides[0]);
+    return true;
+}
+
+/**
+ * @brief Converts a processed image into a dictionary
+ *
+ * @param image Processed image, whose encoded data is moved into the dictionary
+ * @return Dictionary, or nullptr (with an exception set)
+ */
+PyObject* toDict(ProcessedImage&& image) {
+    const ImageResult& result = image.result;
+    PyObject* seconds = PyDict_New();
+    if (!seconds) return nullptr;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (result.seconds[i] < 0) continue;
+        PyObject* value = PyFloat_FromDouble(result.seconds[i]);
+        if (!value || PyDict_SetItemString(seconds, stageName((Stage)i), value) < 0) {
+            Py_XDECREF(value);
+            Py_DECREF(seconds);
+            return nullptr;
+        }
+        Py_DECREF(value);
+    }
+    PyObject* data = nullptr;
+    if (result.ok) {
+        data = wrapEncoded(std::move(image.data));
+    } else {
+        Py_INCREF(Py_None);
+        data = Py_None;
+    }
+    // N hands over the references, even if the dictionary cannot be built
+    return Py_BuildValue("{s:s,s:O,s:z,s:z,s:z,s:i,s:i,s:K,s:K,s:N,s:N}",
+                         "url", result.url.c_str(),
+                         "ok", result.ok ? Py_True : Py_False,
+                         "error", result.error.empty() ? nullptr : result.error.c_str(),
+                         "output", result.output.empty() ? nullptr : result.output.c_str(),
+                         "sha256", result.sha256.empty() ? nullptr : result.sha256.c_str(),
+                         "width", result.width,
+                         "height", result.height,
+                         "input_bytes", (unsigned long long)result.inputBytes,
+                         "output_bytes", (unsigned long long)result.outputBytes,
+                         "seconds", seconds,
+                         "data", data);
+}
+
+/**
+ * @brief Retrieves the pipeline of a Python object
+ *
+ * @param object Pipeline object
+ * @return Pipeline, or nullptr (with an exception set) if it was not initialized
+ */
+Pipeline* pipelineOf(PyObject* object) {
+    Pipeline* pipeline = ((PipelineObject*)object)->pipeline;
+    if (!pipeline) PyErr_SetString(PyExc_RuntimeError, "pipeline is not initialized");
+    return pipeline;
+}
+
+int pipelineInit(PyObject* object, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"threads", "format", "output", "downloads",
+                                     "keep_downloads", nullptr};
+    Py_ssize_t threads = 0;
+    const char* format = PIPELINE_DEFAULT_FORMAT;
+    const char* output = nullptr;
+    const char* downloads = nullptr;
+    int keep = 0;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "|nszzp", const_cast<char**>(keywords),
+                                     &threads, &format, &output, &downloads, &keep)) {
+        return -1;
+    }
+    if (threads < 0) {
+        PyErr_SetString(PyExc_ValueError, "threads must not be negative");
+        return -1;
+    }
+    // Checked here, so that build() can only fail on the staging directory
+    if (!cv::haveImageWriter(format)) {
+        PyErr_Format(PyExc_ValueError, "no encoder for the %s format", format);
+        return -1;
+    }
+    Pipeline::Builder builder;
+    if (threads > 0) builder.threads((size_t)threads);
+    builder.format(format);
+    if (output) {
+        std::unique_ptr<Storage> storage = makeStorage(output);
+        if (!storage) {
+            PyErr_Format(PyExc_ValueError, "invalid output storage: %s", output);
+            return -1;
+        }
+        builder.output(std::move(storage));
+    }
+    builder.downloads(downloads ? downloads : "", keep);
+
+    std::unique_ptr<Pipeline> pipeline = builder.build();
+    if (!pipeline) {
+        PyErr_SetString(PyExc_OSError, "unable to create the staging directory of the downloads");
+        return -1;
+    }
+    PipelineObject* self = (PipelineObject*)object;
+    delete self->pipeline;
+    self->pipeline = pipeline.release();
+    return 0;
+}
+
+void pipelineDealloc(PyObject* object) {
+    PipelineObject* self = (PipelineObject*)object;
+    PyTypeObject* type = Py_TYPE(object);
+    delete self->pipeline;
+    type->tp_free(object);
+    Py_DECREF(type);
+}
+
+PyObject* pipelineProcess(PyObject* object, PyObject* arg) {
+    Pipeline* pipeline = pipelineOf(object);
+    if (!pipeline) return nullptr;
+    std::vector<std::string> urls;
+    PyObject* iterator = PyObject_GetIter(arg);
+    if (!iterator) return nullptr;
+    while (PyObject* item = PyIter_Next(iterator)) {
+        // Paths (e.g., pathlib.Path) are accepted as well as strings
+        PyObject* url = PyOS_FSPath(item);
+        Py_DECREF(item);
+        if (!url) break;
+        if (PyBytes_Check(url)) {
+            urls.emplace_back(PyBytes_AS_STRING(url), PyBytes_GET_SIZE(url));
+        } else {
+            Py_ssize_t size = 0;
+            const char* text = PyUnicode_AsUTF8AndSize(url, &size);
+            if (text) urls.emplace_back(text, size);
+        }
+        Py_DECREF(url);
+        if (PyErr_Occurred()) break;
+    }
+    Py_DECREF(iterator);
+    if (PyErr_Occurred()) return nullptr;
+
+    std::vector<ProcessedImage> images(urls.size());
+    bool done = withoutGil([&] {
+        // Each image is moved into its own position, whatever the thread
+        pipeline->process(urls, [&images](ProcessedImage&& image) {
+            images[image.index] = std::move(image);
+        });
+    });
+    if (!done) return nullptr;
+
+    PyObject* list = PyList_New((Py_ssize_t)images.size());
+    if (!list) return nullptr;
+    for (size_t i = 0; i < images.size(); i++) {
+        PyObject* item = toDict(std::move(images[i]));
+        if (!item) {
+            Py_DECREF(list);
+            return nullptr;
+        }
+        PyList_SET_ITEM(list, (Py_ssize_t)i, item);
+    }
+    return list;
+}
+
+PyObject* pipelineConvert(PyObject* object, PyObject* arg) {
+    Pipeline* pipeline = pipelineOf(object);
+    if (!pipeline) return nullptr;
+    Buffer buffer;
+    if (!buffer.get(arg, PyBUF_SIMPLE)) return nullptr;
+    const Py_buffer& view = buffer.view();
+    ProcessedImage image;
+    bool done = withoutGil([&] {
+        image = pipeline->convert((const unsigned char*)view.buf, (size_t)view.len);
+    });
+    if (!done) return nullptr;
+    if (!image.result.ok) {
+        PyErr_SetString(PyExc_ValueError, image.result.error.c_str());
+        return nullptr;
+    }
+    return wrapEncoded(std::move(image.data));
+}
+
+PyObject* pipelineApply(PyObject* object, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"image", "out", nullptr};
+    PyObject* input = nullptr;
+    PyObject* out = Py_None;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|O", const_cast<char**>(keywords), &input,
+                                     &out)) {
+        return nullptr;
+    }
+    Pipeline* pipeline = pipelineOf(object);
+    if (!pipeline) return nullptr;
+    Buffer inputBuffer, outputBuffer;
+    cv::Mat image, result;
+    if (!wrapBuffer(input, false, inputBuffer, image)) return nullptr;
+    if (out != Py_None && !wrapBuffer(out, true, outputBuffer, result)) return nullptr;
+    const unsigned char* target = result.data;
+
+    bool transformed = false;
+    bool done = withoutGil([&] { transformed = pipeline->apply(image, result); });
+    if (!done) return nullptr;
+    if (!transformed) {
+        PyErr_SetString(PyExc_ValueError, "unable to transform the image");
+        return nullptr;
+    }
+    if (out != Py_None) {
+        // OpenCV reallocates the output instead of writing into a mismatching one
+        if (result.data != target) {
+            PyErr_SetString(PyExc_ValueError,
+                            "out does not match the size and channels of the transformed image");
+            return nullptr;
+        }
+        Py_INCREF(out);
+        return out;
+    }
+    // The result must not share the memory of the input, released on return
+    if (result.data == image.data) result = result.clone();
+    return wrapImage(std::move(result));
+}
+
+PyObject* decode(PyObject*, PyObject* arg) {
+    Buffer buffer;
+    if (!buffer.get(arg, PyBUF_SIMPLE)) return nullptr;
+    const Py_buffer& view = buffer.view();
+    cv::Mat image;
+    bool done = withoutGil([&] {
+        cv::Mat encoded(1, (int)view.len, CV_8U, view.buf);
+        image = cv::imdecode(encoded, cv::IMREAD_UNCHANGED);
+    });
+    if (!done) return nullptr;
+    if (image.empty() || image.depth() != CV_8U) {
+        PyErr_SetString(PyExc_ValueError, "unable to decode");
+        return nullptr;
+    }
+    return wrapImage(std::move(image));
+}
+
+PyObject* encode(PyObject*, PyObject* args, PyObject* kwargs) {
+    static const char* keywords[] = {"image", "format", nullptr};
+    PyObject* input = nullptr;
+    const char* format = PIPELINE_DEFAULT_FORMAT;
+    if (!PyArg_ParseTupleAndKeywords(args, kwargs, "O|s", const_cast<char**>(keywords), &input,
+                                     &format)) {
+        return nullptr;
+    }
+    Buffer buffer;
+    cv::Mat image;
+    if (!cv::haveImageWriter(format)) {
+        PyErr_Format(PyExc_ValueError, "no encoder for the %s format", format);
+        return nullptr;
+    }
+    if (!wrapBuffer(input, false, buffer, image)) return nullptr;
+    std::string extension = format;
+    std::vector<unsigned char> data;
+    bool encoded = false;
+    bool done = withoutGil([&] { encoded = cv::imencode(extension, image, data); });
+    if (!done) return nullptr;
+    if (!encoded) {
+        PyErr_Format(PyExc_ValueError, "unable to encode as %s", format);
+        return nullptr;
+    }
+    return wrapEncoded(std::move(data));
+}
+
+PyGetSetDef imageGetSet[] = {
+    {"shape", imageShape, nullptr, "Size of each dimension of the image", nullptr},
+    {nullptr, nullptr, nullptr, nullptr, nullptr},
+};
+
+PyType_Slot imageSlots[] = {
+    {Py_tp_doc, (void*)"Image owned by the module, exposed through the buffer protocol "
+                       "(e.g., numpy.asarray(image) shares its memory)"},
+    {Py_tp_dealloc, (void*)imageDealloc},
+    {Py_tp_getset, (void*)imageGetSet},
+    {Py_bf_getbuffer, (void*)imageGetBuffer},
+    {0, nullptr},
+};
+
+// Images are only created by the module, never from Python
+PyType_Spec imageSpec = {"imageprocessing.Image", sizeof(ImageObject), 0,
+                         Py_TPFLAGS_DEFAULT | Py_TPFLAGS_DISALLOW_INSTANTIATION, imageSlots};
+
+PyMethodDef pipelineMethods[] = {
+    {"process", pipelineProcess, METH_O,
+     "process(urls) -> list of dict\n\n"
+     "Downloads and processes a batch of images (URLs or local paths), releasing the GIL "
+     "meanwhile. Each dict holds the outcome of an image (url, ok, error, output, sha256, "
+     "width, height, input_bytes, output_bytes, seconds per stage) and, if ok, the processed "
+     "image, encoded, as data."},
+    {"convert", pipelineConvert, METH_O,
+     "convert(data) -> Image\n\n"
+     "Processes an encoded image held by a bytes-like object, returning it encoded."},
+    {"apply", (PyCFunction)(void (*)(void))pipelineApply, METH_VARARGS | METH_KEYWORDS,
+     "apply(image, out=None) -> Image or out\n\n"
+     "Transforms a decoded image (e.g., a uint8 numpy array of rows, columns and channels) "
+     "without copying it. If out is given, the transformed image is written into it."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyType_Slot pipelineSlots[] = {
+    {Py_tp_doc, (void*)"Pipeline(threads=0, format='.jpg', output=None, downloads=None, "
+                       "keep_downloads=False)\n\n"
+                       "Pipeline downloading and transforming (to grayscale) batches of images "
+                       "on threads of its own. threads is the number of threads processing "
+                       "images (0 for the number of cores), format the extension of the format "
+                       "they are encoded into (ValueError if OpenCV has no encoder for it), output an optional storage (local "
+                       "directory or s3://BUCKET[/PREFIX]) the processed images are also written "
+                       "to and downloads the staging directory of the downloads (a private "
+                       "temporary one by default)"},
+    {Py_tp_new, (void*)PyType_GenericNew},
+    {Py_tp_init, (void*)pipelineInit},
+    {Py_tp_dealloc, (void*)pipelineDealloc},
+    {Py_tp_methods, (void*)pipelineMethods},
+    {0, nullptr},
+};
+
+PyType_Spec pipelineSpec = {"imageprocessing.Pipeline", sizeof(PipelineObject), 0,
+                            Py_TPFLAGS_DEFAULT | Py_TPFLAGS_BASETYPE, pipelineSlots};
+
+PyMethodDef moduleMethods[] = {
+    {"decode", decode, METH_O,
+     "decode(data) -> Image\n\n"
+     "Decodes an image held by a bytes-like object, keeping its channels."},
+    {"encode", (PyCFunction)(void (*)(void))encode, METH_VARARGS | METH_KEYWORDS,
+     "encode(image, format='.jpg') -> Image\n\n"
+     "Encodes a decoded image (e.g., a uint8 numpy array) into a format."},
+    {nullptr, nullptr, 0, nullptr},
+};
+
+PyModuleDef moduleDef = {
+    PyModuleDef_HEAD_INIT,
+    "imageprocessing",
+    "Image processing pipeline. Images cross the module through the buffer protocol, without "
+    "being copied, and the GIL is released while they are downloaded and processed.",
+    -1,
+    moduleMethods,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+};
+
+/**
+ * @brief Creates a type and adds it to a module
+ *
+ * @param module Module
+ * @param spec Specification of the type
+ * @param name Name of the type within the module
+ * @return Type, or nullptr (with an exception set)
+ */
+PyTypeObject* addType(PyObject* module, PyType_Spec* spec, const char* name) {
+    PyObject* type = PyType_FromSpec(spec);
+    if (!type) return nullptr;
+    // The module keeps a reference of its own, the caller the one returned
+    Py_INCREF(type);
+    if (PyModule_AddObject(module, name, type) < 0) {
+        Py_DECREF(type);
+        Py_DECREF(type);
+        return nullptr;
+    }
+    return (PyTypeObject*)type;
+}
+
+}  // namespace
+
+PyMODINIT_FUNC PyInit_imageprocessing() {
+    PyObject* module = PyModule_Create(&moduleDef);
+    if (!module) return nullptr;
+    imageType = addType(module, &imageSpec, "Image");
+    pipelineType = imageType ? addType(module, &pipelineSpec, "Pipeline") : nullptr;
+    if (!pipelineType) {
+        Py_DECREF(module);
+        return nullptr;
+    }
+    return module;
+}
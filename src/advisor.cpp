@@ -0,0 +1,152 @@
+/**
+ * @file	advisor.cpp
+ * @brief	Analysis of the bottlenecks of a run
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "advisor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Names a pool after its stages (e.g., read+convert+upload)
+ *
+ * @param pool Load of the pool
+ * @return Name of the pool
+ */
+std::string poolName(const PoolLoad& pool) {
+    std::string name = stageName(pool.first);
+    for (int i = (int)pool.first + 1; i <= (int)pool.last; i++) {
+        name += '+';
+        name += stageName((Stage)i);
+    }
+    return name;
+}
+
+/**
+ * @brief Names the workers of a pool
+ *
+ * @param pool Load of the pool
+ * @return Plural name of the workers
+ */
+const char* workerName(const PoolLoad& pool) {
+    // Downloads are transfers of a single thread, limited by the images in flight
+    return pool.first == Stage::Download ? "connections" : "threads";
+}
+
+/**
+ * @brief Computes the fraction of the workers of a pool busy while active
+ *
+ * @param pool Load of the pool
+ * @return Utilization, between 0 and 1
+ */
+double utilization(const PoolLoad& pool) {
+    return pool.workers > 0 ? std::min(1.0, pool.busy / pool.workers) : 0;
+}
+
+}  // namespace
+
+void printBottleneckAnalysis(const std::vector<PoolLoad>& pools, double seconds,
+                             std::ostream& out) {
+    if (pools.empty() || seconds <= 0) {
+        out << "Bottleneck analysis: the run was too short to be sampled" << std::endl;
+        return;
+    }
+    const PoolLoad* limiting = nullptr;
+    for (const PoolLoad& pool : pools) {
+        if (pool.activeSeconds <= 0) continue;
+        if (!limiting || pool.saturatedSeconds > limiting->saturatedSeconds ||
+            (pool.saturatedSeconds == limiting->saturatedSeconds &&
+             utilization(pool) * pool.activeSeconds >
+                 utilization(*limiting) * limiting->activeSeconds)) {
+            limiting = &pool;
+        }
+    }
+
+    char text[256];
+    snprintf(text, sizeof(text), "Bottleneck analysis (%.1f s sampled):", seconds);
+    out << text << std::endl;
+    if (!limiting) {
+        out << "  no stage was busy long enough to be sampled" << std::endl;
+        return;
+    }
+    if (limiting->saturatedSeconds > 0) {
+        snprintf(text, sizeof(text),
+                 "  limiting: %s, every worker busy %.0f%% of the run, %.1f items waiting",
+                 poolName(*limiting).c_str(), 100 * limiting->saturatedSeconds / seconds,
+                 limiting->queued);
+    } else {
+        snprintf(text, sizeof(text),
+                 "  limiting: %s, the busiest (%.0f%% of its workers), %.1f items waiting",
+                 poolName(*limiting).c_str(), 100 * utilization(*limiting), limiting->queued);
+    }
+    out << text << std::endl;
+
+    for (const PoolLoad& pool : pools) {
+        if (pool.activeSeconds <= 0) {
+            snprintf(text, sizeof(text), "  %s: %llu items, never busy when sampled",
+                     poolName(pool).c_str(), (unsigned long long)pool.items);
+            out << text << std::endl;
+            continue;
+        }
+        double busy = utilization(pool);
+        // Little's law: throughput and time of each item in the pool
+        double throughput = pool.items / pool.activeSeconds;
+        double itemSeconds = pool.busy / throughput;
+        snprintf(text, sizeof(text),
+                 "  %s: %.1f %s, %.1f busy (%.0f%%), %.1f waiting, %.1f items/s, %.3f s per item",
+                 poolName(pool).c_str(), pool.workers, workerName(pool), pool.busy,
+                 100 * busy, pool.queued, throughput, itemSeconds);
+        out << text << std::endl;
+        if (pool.first != pool.last) {
+            std::string shares = "    time spent in";
+            for (int i = (int)pool.first; i <= (int)pool.last; i++) {
+                snprintf(text, sizeof(text), " %s %.0f%%", stageName((Stage)i),
+                         100 * pool.share[i]);
+                shares += text;
+            }
+            out << shares << std::endl;
+        }
+
+        if (busy >= ADVISOR_SATURATED && pool.queued >= ADVISOR_MIN_QUEUE) {
+            // As many workers as items present would serve them all at once
+            double present = pool.busy + pool.queued;
+            double speedup = present / pool.busy;
+            double estimate = seconds - pool.activeSeconds * (1 - 1 / speedup);
+            snprintf(text, sizeof(text),
+                     "    saturated: about %.0f %s would keep up, up to %.1fx faster "
+                     "(run in about %.1f s)",
+                     std::ceil(present), workerName(pool), speedup, estimate);
+        } else if (busy >= ADVISOR_SATURATED) {
+            snprintf(text, sizeof(text),
+                     "    saturated but starved: more %s would wait for the stages before it",
+                     workerName(pool));
+        } else if (pool.queued >= ADVISOR_MIN_QUEUE) {
+            snprintf(text, sizeof(text),
+                     "    underused: items waited while %s were free, so something else limits "
+                     "it (e.g., limits per host)",
+                     workerName(pool));
+        } else if (pool.workers > 1.5) {
+            snprintf(text, sizeof(text), "    oversized: about %.0f %s would suffice",
+                     std::ceil(pool.busy / ADVISOR_SATURATED), workerName(pool));
+        } else {
+            text[0] = '\0';
+        }
+        if (text[0]) out << text << std::endl;
+
+        double idle = 1 - pool.activeSeconds / seconds;
+        if (idle >= ADVISOR_IDLE) {
+            snprintf(text, sizeof(text), "    idle %.0f%% of the run%s", 100 * idle,
+                     &pool == limiting ? ""
+                                       : ": its work could overlap with that of the others");
+            out << text << std::endl;
+        }
+    }
+}
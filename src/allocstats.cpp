@@ -0,0 +1,233 @@
+/**
+ * @file	allocstats.cpp
+ * @brief	Accounting of the memory allocations of each task
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "allocstats.h"
+
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#define ALLOC_STATS_SUPPORTED 1
+#elif defined(__APPLE__)
+#include <malloc/malloc.h>
+#define ALLOC_STATS_SUPPORTED 1
+#endif
+
+#include "log.h"
+
+namespace {
+
+/** @brief Whether allocations are accounted */
+std::atomic<bool> enabled{false};
+
+/**
+ * @brief Allocations of a task
+ * @details Aligned to a cache line, so that threads working on different
+ *          tasks do not contend on the same line
+ */
+struct alignas(64) Counters {
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> frees;
+    std::atomic<uint64_t> freedBytes;
+    std::atomic<uint64_t> peakLive;
+};
+
+/**
+ * @brief Allocations of each task
+ * @details Zero-initialized before any allocation, as the allocation
+ *          functions may be called before the dynamic initialization
+ */
+Counters counters[TASK_COUNT];
+
+/** @brief Bytes live in the process, allocated but not freed since accounting started */
+std::atomic<int64_t> live{0};
+
+/**
+ * @brief Accounts an allocation to the task of the calling thread
+ *
+ * @param size Size of the allocated block
+ */
+void allocated(size_t size) {
+    Counters& task = counters[(int)currentTask()];
+    task.allocations.fetch_add(1, std::memory_order_relaxed);
+    task.bytes.fetch_add(size, std::memory_order_relaxed);
+    int64_t now = live.fetch_add((int64_t)size, std::memory_order_relaxed) + (int64_t)size;
+    if (now <= 0) return;
+    uint64_t peak = task.peakLive.load(std::memory_order_relaxed);
+    while ((uint64_t)now > peak &&
+           !task.peakLive.compare_exchange_weak(peak, (uint64_t)now, std::memory_order_relaxed)) {
+    }
+}
+
+/**
+ * @brief Accounts a release to the task of the calling thread
+ *
+ * @param size Size of the freed block
+ */
+void freed(size_t size) {
+    Counters& task = counters[(int)currentTask()];
+    task.frees.fetch_add(1, std::memory_order_relaxed);
+    task.freedBytes.fetch_add(size, std::memory_order_relaxed);
+    live.fetch_sub((int64_t)size, std::memory_order_relaxed);
+}
+
+/** @brief Whether allocations are accounted, checked on every allocation */
+inline bool accounting() {
+    return enabled.load(std::memory_order_relaxed);
+}
+
+}  // namespace
+
+#if defined(__GLIBC__)
+
+// The allocation functions of the C library are replaced by functions
+// forwarding to the implementations glibc exports for that purpose, so that
+// every allocation of the process is seen, including those of the libraries
+extern "C" {
+
+void* __libc_malloc(size_t size) noexcept;
+void __libc_free(void* block) noexcept;
+void* __libc_calloc(size_t count, size_t size) noexcept;
+void* __libc_realloc(void* block, size_t size) noexcept;
+void* __libc_memalign(size_t alignment, size_t size) noexcept;
+void* __libc_valloc(size_t size) noexcept;
+void* __libc_pvalloc(size_t size) noexcept;
+
+void* malloc(size_t size) noexcept {
+    void* block = __libc_malloc(size);
+    if (block && accounting()) allocated(malloc_usable_size(block));
+    return block;
+}
+
+void free(void* block) noexcept {
+    if (block && accounting()) freed(malloc_usable_size(block));
+    __libc_free(block);
+}
+
+void* calloc(size_t count, size_t size) noexcept {
+    void* block = __libc_calloc(count, size);
+    if (block && accounting()) allocated(malloc_usable_size(block));
+    return block;
+}
+
+void* realloc(void* block, size_t size) noexcept {
+    size_t previous = block && accounting() ? malloc_usable_size(block) : 0;
+    void* moved = __libc_realloc(block, size);
+    if (accounting()) {
+        // A failed reallocation keeps the block, unless it was a release (size 0)
+        if (previous && (moved || size == 0)) freed(previous);
+        if (moved) allocated(malloc_usable_size(moved));
+    }
+    return moved;
+}
+
+void* reallocarray(void* block, size_t count, size_t size) noexcept {
+    if (size && count > (size_t)-1 / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return realloc(block, count * size);
+}
+
+void* memalign(size_t alignment, size_t size) noexcept {
+    void* block = __libc_memalign(alignment, size);
+    if (block && accounting()) allocated(malloc_usable_size(block));
+    return block;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) noexcept {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** result, size_t alignment, size_t size) noexcept {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) return EINVAL;
+    void* block = memalign(alignment, size);
+    if (!block) return ENOMEM;
+    *result = block;
+    return 0;
+}
+
+void* valloc(size_t size) noexcept {
+    void* block = __libc_valloc(size);
+    if (block && accounting()) allocated(malloc_usable_size(block));
+    return block;
+}
+
+void* pvalloc(size_t size) noexcept {
+    void* block = __libc_pvalloc(size);
+    if (block && accounting()) allocated(malloc_usable_size(block));
+    return block;
+}
+
+}  // extern "C"
+
+#elif defined(__APPLE__)
+
+// The C library cannot be replaced from the program, so only the global
+// operator new and delete are (the other forms forward to these)
+void* operator new(size_t size) {
+    void* block;
+    while (!(block = malloc(size ? size : 1))) {
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) throw std::bad_alloc();
+        handler();
+    }
+    if (accounting()) allocated(malloc_size(block));
+    return block;
+}
+
+void operator delete(void* block) noexcept {
+    if (block && accounting()) freed(malloc_size(block));
+    free(block);
+}
+
+#endif
+
+void startAllocationStats() {
+#ifdef ALLOC_STATS_SUPPORTED
+    enabled.store(true);
+#else
+    LOG_WARNING("allocation accounting is not supported on this platform");
+#endif
+}
+
+bool allocationStatsEnabled() {
+    return enabled.load();
+}
+
+std::vector<TaskAllocations> allocationStats() {
+    std::vector<TaskAllocations> stats;
+    for (int i = 0; i < TASK_COUNT; i++) {
+        TaskAllocations entry;
+        entry.task = (Task)i;
+        entry.allocations = counters[i].allocations.load(std::memory_order_relaxed);
+        entry.bytes = counters[i].bytes.load(std::memory_order_relaxed);
+        entry.frees = counters[i].frees.load(std::memory_order_relaxed);
+        entry.freedBytes = counters[i].freedBytes.load(std::memory_order_relaxed);
+        entry.peakLive = counters[i].peakLive.load(std::memory_order_relaxed);
+        if (entry.allocations > 0 || entry.frees > 0) stats.push_back(entry);
+    }
+    return stats;
+}
+
+void printAllocationStats(const std::vector<TaskAllocations>& stats, std::ostream& out) {
+    out << "Allocations per task (allocations, MB, mean bytes, frees, MB freed, "
+        << "peak live MB):" << std::endl;
+    const double MB = 1024.0 * 1024.0;
+    for (const TaskAllocations& entry : stats) {
+        out << "  " << taskName(entry.task) << ": " << entry.allocations << ", "
+            << entry.bytes / MB << ", "
+            << (entry.allocations > 0 ? entry.bytes / entry.allocations : 0) << ", "
+            << entry.frees << ", " << entry.freedBytes / MB << ", " << entry.peakLive / MB
+            << std::endl;
+    }
+}
@@ -0,0 +1,436 @@
+/**
+ * @file	crawler.cpp
+ * @brief	Crawler extracting image URLs from HTML pages
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "crawler.h"
+
+#include <strings.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+
+#include "dnscache.h"
+#include "log.h"
+#include "task.h"
+#include "tlscache.h"
+
+namespace {
+
+/** @brief Maximum length of an attribute value kept by the scanner */
+const size_t MAX_VALUE_LENGTH = 64 * 1024;
+
+/** @brief URL resolved against the URL of a page */
+struct Link {
+    std::string url;   ///< Absolute URL, without fragment
+    std::string host;  ///< Host name, in lowercase
+    std::string path;  ///< Path, in lowercase
+};
+
+/**
+ * @brief Resolves a (possibly relative) reference against a base URL
+ *
+ * @param base Base URL
+ * @param ref Reference, as found in the page
+ * @param link Resolved URL
+ * @return true if the reference resolves to an HTTP(S) URL, false otherwise
+ */
+bool resolve(const std::string& base, const std::string& ref, Link& link) {
+    size_t first = ref.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return false;
+    size_t last = ref.find_last_not_of(" \t\r\n");
+    std::string trimmed = ref.substr(first, last - first + 1);
+
+    CURLU* handle = curl_url();
+    if (!handle) return false;
+    bool ok = false;
+    char* scheme = nullptr;
+    char* url = nullptr;
+    char* host = nullptr;
+    char* path = nullptr;
+    if (curl_url_set(handle, CURLUPART_URL, base.c_str(), 0) == CURLUE_OK &&
+        curl_url_set(handle, CURLUPART_URL, trimmed.c_str(), 0) == CURLUE_OK &&
+        curl_url_set(handle, CURLUPART_FRAGMENT, nullptr, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_SCHEME, &scheme, 0) == CURLUE_OK &&
+        (strcmp(scheme, "http") == 0 || strcmp(scheme, "https") == 0) &&
+        curl_url_get(handle, CURLUPART_URL, &url, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_HOST, &host, 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_PATH, &path, 0) == CURLUE_OK) {
+        link.url = url;
+        link.host = host;
+        link.path = path;
+        std::transform(link.host.begin(), link.host.end(), link.host.begin(), ::tolower);
+        std::transform(link.path.begin(), link.path.end(), link.path.begin(), ::tolower);
+        ok = true;
+    }
+    curl_free(scheme);
+    curl_free(url);
+    curl_free(host);
+    curl_free(path);
+    curl_url_cleanup(handle);
+    return ok;
+}
+
+/**
+ * @brief Checks whether a path ends with one of the given extensions
+ *
+ * @param path Path, in lowercase
+ * @param extensions Extensions, including the dot
+ * @return true if the path ends with one of the extensions, false otherwise
+ */
+bool hasExtension(const std::string& path, std::initializer_list<const char*> extensions) {
+    for (const char* extension : extensions) {
+        size_t length = strlen(extension);
+        if (path.size() >= length && path.compare(path.size() - length, length, extension) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Picks the largest image candidate of a srcset attribute
+ * @details Candidates are separated by commas, each one being a URL
+ *          optionally followed by a width (640w) or density (2x) descriptor
+ *
+ * @param srcset Value of the attribute
+ * @return URL of the candidate with the largest descriptor
+ */
+std::string largestCandidate(const std::string& srcset) {
+    std::string best;
+    double bestSize = -1;
+    size_t i = 0;
+    while (i < srcset.size()) {
+        while (i < srcset.size() && (isspace((unsigned char)srcset[i]) || srcset[i] == ',')) i++;
+        size_t start = i;
+        while (i < srcset.size() && !isspace((unsigned char)srcset[i])) i++;
+        std::string url = srcset.substr(start, i - start);
+        // A comma ending the URL separates it from the next candidate
+        bool hasDescriptor = true;
+        if (!url.empty() && url.back() == ',') {
+            url.pop_back();
+            hasDescriptor = false;
+        }
+        size_t end = hasDescriptor ? srcset.find(',', i) : i;
+        if (end == std::string::npos) end = srcset.size();
+        double size = hasDescriptor ? strtod(srcset.c_str() + i, nullptr) : 0;
+        if (size <= 0) size = 1;
+        if (!url.empty() && size > bestSize) {
+            best = url;
+            bestSize = size;
+        }
+        i = end;
+    }
+    return best;
+}
+
+}  // namespace
+
+HtmlLinkScanner::HtmlLinkScanner(Handler handler) : handler_(std::move(handler)) {}
+
+bool HtmlLinkScanner::interesting() const {
+    return tag_ == "img" || tag_ == "source" || tag_ == "a" || tag_ == "base";
+}
+
+void HtmlLinkScanner::endAttribute() {
+    bool image = tag_ == "img" || tag_ == "source";
+    if ((image && (attr_ == "src" || attr_ == "data-src" || attr_ == "srcset")) ||
+        (!image && attr_ == "href")) {
+        size_t amp;
+        while ((amp = value_.find("&amp;")) != std::string::npos) value_.erase(amp + 1, 4);
+        handler_(tag_, attr_, value_);
+    }
+    attr_.clear();
+    value_.clear();
+}
+
+void HtmlLinkScanner::endTag() {
+    state_ = State::Text;
+    if (!closing_ && (tag_ == "script" || tag_ == "style")) {
+        rawEnd_ = "</" + tag_;
+        rawMatched_ = 0;
+        state_ = State::RawText;
+    }
+}
+
+void HtmlLinkScanner::feed(const char* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        char c = data[i];
+        char lower = (char)tolower((unsigned char)c);
+        bool space = isspace((unsigned char)c);
+        switch (state_) {
+            case State::Text:
+                if (c == '<') state_ = State::TagOpen;
+                break;
+            case State::TagOpen:
+                tag_.clear();
+                closing_ = c == '/';
+                if (closing_ || isalpha((unsigned char)c) || c == '!') {
+                    if (!closing_) tag_ += lower;
+                    state_ = State::TagName;
+                } else {
+                    state_ = c == '<' ? State::TagOpen : State::Text;
+                }
+                break;
+            case State::TagName:
+                if (space || c == '/') {
+                    state_ = interesting() && !closing_ ? State::BeforeAttr : State::SkipTag;
+                } else if (c == '>') {
+                    endTag();
+                } else if (tag_.size() < 16) {
+                    tag_ += lower;
+                    if (tag_ == "!--") {
+                        dashes_ = 0;
+                        state_ = State::Comment;
+                    }
+                }
+                break;
+            case State::BeforeAttr:
+                if (c == '>') {
+                    endTag();
+                } else if (!space && c != '/') {
+                    attr_ = lower;
+                    state_ = State::AttrName;
+                }
+                break;
+            case State::AttrName:
+                if (c == '=') {
+                    state_ = State::BeforeValue;
+                } else if (space) {
+                    state_ = State::AfterAttrName;
+                } else if (c == '>' || c == '/') {
+                    endAttribute();
+                    if (c == '>') endTag(); else state_ = State::BeforeAttr;
+                } else {
+                    attr_ += lower;
+                }
+                break;
+            case State::AfterAttrName:
+                if (c == '=') {
+                    state_ = State::BeforeValue;
+                } else if (c == '>') {
+                    endAttribute();
+                    endTag();
+                } else if (!space) {
+                    endAttribute();
+                    attr_ = lower;
+                    state_ = State::AttrName;
+                }
+                break;
+            case State::BeforeValue:
+                if (c == '"' || c == '\'') {
+                    quote_ = c;
+                    state_ = State::QuotedValue;
+                } else if (c == '>') {
+                    endAttribute();
+                    endTag();
+                } else if (!space) {
+                    value_ += c;
+                    state_ = State::UnquotedValue;
+                }
+                break;
+            case State::QuotedValue:
+                if (c == quote_) {
+                    endAttribute();
+                    state_ = State::BeforeAttr;
+                } else if (value_.size() < MAX_VALUE_LENGTH) {
+                    value_ += c;
+                }
+                break;
+            case State::UnquotedValue:
+                if (space || c == '>') {
+                    endAttribute();
+                    if (c == '>') endTag(); else state_ = State::BeforeAttr;
+                } else if (value_.size() < MAX_VALUE_LENGTH) {
+                    value_ += c;
+                }
+                break;
+            case State::SkipTag:
+                if (c == '"' || c == '\'') {
+                    quote_ = c;
+                    state_ = State::SkipQuoted;
+                } else if (c == '>') {
+                    endTag();
+                }
+                break;
+            case State::SkipQuoted:
+                if (c == quote_) state_ = State::SkipTag;
+                break;
+            case State::Comment:
+                if (c == '>' && dashes_ >= 2) {
+                    state_ = State::Text;
+                } else {
+                    dashes_ = c == '-' ? dashes_ + 1 : 0;
+                }
+                break;
+            case State::RawText:
+                if (lower == rawEnd_[rawMatched_]) {
+                    if (++rawMatched_ == rawEnd_.size()) {
+                        closing_ = true;
+                        state_ = State::SkipTag;
+                    }
+                } else {
+                    rawMatched_ = lower == rawEnd_[0] ? 1 : 0;
+                }
+                break;
+        }
+    }
+}
+
+/** @brief Page being fetched */
+struct CrawlerUrlSource::Page {
+    CrawlerUrlSource* source;  ///< Source crawling the page
+    std::string url;           ///< URL of the page
+    int depth;                 ///< Links followed from the seeds
+    std::string base;          ///< URL against which links are resolved
+    CURL* curl = nullptr;
+    bool checked = false;      ///< Whether the content type was checked
+    bool html = false;         ///< Whether the page is an HTML document
+    size_t size = 0;           ///< Bytes scanned
+    std::unique_ptr<HtmlLinkScanner> scanner;
+};
+
+CrawlerUrlSource::CrawlerUrlSource(const std::vector<std::string>& seeds, int maxDepth,
+                                   bool sameHost)
+    : seeds_(seeds), maxDepth_(maxDepth), sameHost_(sameHost), multi_(curl_multi_init()) {
+    for (const auto& seed : seeds_) {
+        Link link;
+        if (!resolve(seed, seed, link)) {
+            LOG_ERROR("invalid URL " << seed);
+            continue;
+        }
+        hosts_.insert(link.host);
+        if (seenPages_.insert(link.url).second) frontier_.emplace_back(link.url, 0);
+    }
+}
+
+CrawlerUrlSource::~CrawlerUrlSource() {
+    drain();
+    for (auto& page : pages_) {
+        curl_multi_remove_handle(multi_, page->curl);
+        curl_easy_cleanup(page->curl);
+    }
+    curl_multi_cleanup(multi_);
+}
+
+std::string CrawlerUrlSource::name() const {
+    return "crawler from " + (seeds_.empty() ? std::string() : seeds_.front());
+}
+
+size_t CrawlerUrlSource::writeCallback(char* data, size_t size, size_t count, void* userp) {
+    Page& page = *(Page*)userp;
+    size_t bytes = size * count;
+    if (!page.checked) {
+        char* type = nullptr;
+        char* url = nullptr;
+        curl_easy_getinfo(page.curl, CURLINFO_CONTENT_TYPE, &type);
+        curl_easy_getinfo(page.curl, CURLINFO_EFFECTIVE_URL, &url);
+        page.html = type && (strncasecmp(type, "text/html", 9) == 0 ||
+                             strncasecmp(type, "application/xhtml+xml", 21) == 0);
+        page.base = url ? url : page.url;
+        page.checked = true;
+    }
+    // Returning less than received aborts transfers of other content or too large
+    if (!page.html || page.size + bytes > (size_t)CRAWLER_MAX_PAGE_SIZE) return 0;
+    page.size += bytes;
+    page.scanner->feed(data, bytes);
+    return bytes;
+}
+
+void CrawlerUrlSource::start(const std::string& url, int depth) {
+    auto page = std::make_unique<Page>();
+    Page* raw = page.get();
+    page->source = this;
+    page->url = url;
+    page->depth = depth;
+    page->base = url;
+    page->scanner = std::make_unique<HtmlLinkScanner>(
+        [raw](const std::string& tag, const std::string& attr, const std::string& value) {
+            raw->source->found(*raw, tag, attr, value);
+        });
+    page->curl = curl_easy_init();
+    if (!page->curl) return;
+
+    curl_easy_setopt(page->curl, CURLOPT_URL, url.c_str());
+    DnsCache::instance().apply(page->curl, url);
+    TlsSessionCache::instance().apply(page->curl, true);
+    curl_easy_setopt(page->curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(page->curl, CURLOPT_MAXREDIRS, 5L);
+    curl_easy_setopt(page->curl, CURLOPT_FAILONERROR, 1L);
+    curl_easy_setopt(page->curl, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(page->curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(page->curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(page->curl, CURLOPT_WRITEDATA, raw);
+    curl_multi_add_handle(multi_, page->curl);
+    pages_.push_back(std::move(page));
+    fetched_++;
+}
+
+void CrawlerUrlSource::found(Page& page, const std::string& tag, const std::string& attr,
+                             const std::string& value) {
+    Link link;
+    if (!resolve(page.base, attr == "srcset" ? largestCandidate(value) : value, link)) return;
+
+    if (tag == "base") {
+        page.base = link.url;
+    } else if (tag == "img" || tag == "source") {
+        // OpenCV does not decode vector or animated images
+        if (!hasExtension(link.path, {".svg", ".gif"}) && seenImages_.insert(link.url).second) {
+            images_.push_back(link.url);
+        }
+    } else if (hasExtension(link.path, {".jpg", ".jpeg", ".png", ".webp"})) {
+        if (seenImages_.insert(link.url).second) images_.push_back(link.url);
+    } else if (page.depth < maxDepth_ && (!sameHost_ || hosts_.count(link.host)) &&
+               seenPages_.insert(link.url).second) {
+        frontier_.emplace_back(link.url, page.depth + 1);
+    }
+}
+
+std::vector<std::string> CrawlerUrlSource::produce(size_t count) {
+    TaskScope task(Task::Crawl);
+    while (images_.size() < count) {
+        while (pages_.size() < CRAWLER_MAX_CONCURRENT && !frontier_.empty() &&
+               fetched_ < CRAWLER_MAX_PAGES) {
+            start(frontier_.front().first, frontier_.front().second);
+            frontier_.pop_front();
+        }
+        if (pages_.empty()) break;
+
+        int running = 0;
+        curl_multi_perform(multi_, &running);
+        CURLMsg* msg;
+        int messages;
+        while ((msg = curl_multi_info_read(multi_, &messages))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            auto it = std::find_if(pages_.begin(), pages_.end(),
+                                   [msg](const auto& page) { return page->curl == msg->easy_handle; });
+            if (it == pages_.end()) continue;
+            Page& page = **it;
+            // Pages of other content are aborted on purpose
+            if (msg->data.result != CURLE_OK && (!page.checked || page.html)) {
+                LOG_ERROR("unable to crawl " << page.url << ": " <<
+                    curl_easy_strerror(msg->data.result));
+            }
+            curl_multi_remove_handle(multi_, page.curl);
+            curl_easy_cleanup(page.curl);
+            pages_.erase(it);
+        }
+        if (images_.size() < count && !pages_.empty()) {
+            curl_multi_poll(multi_, nullptr, 0, 1000, nullptr);
+        }
+    }
+
+    std::vector<std::string> urls;
+    while (urls.size() < count && !images_.empty()) {
+        urls.push_back(std::move(images_.front()));
+        images_.pop_front();
+    }
+    // Resolve the hosts of the images while they wait to be downloaded
+    DnsCache::instance().prefetch(urls);
+    return urls;
+}
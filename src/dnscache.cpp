@@ -0,0 +1,225 @@
+/**
+ * @file	dnscache.cpp
+ * @brief	Cache of resolved host names shared by all HTTP requests
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "dnscache.h"
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+namespace {
+
+/**
+ * @brief Retrieves the host and port of a URL
+ *
+ * @param url URL
+ * @param host Host name (in lowercase)
+ * @param port Port, explicit or the default one of the scheme
+ * @return true if the URL is valid, false otherwise
+ */
+bool hostAndPort(const std::string& url, std::string& host, long& port) {
+    CURLU* handle = curl_url();
+    if (!handle) return false;
+    char* hostPart = nullptr;
+    char* portPart = nullptr;
+    bool ok = curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_HOST, &hostPart, 0) == CURLUE_OK &&
+              curl_url_get(handle, CURLUPART_PORT, &portPart, CURLU_DEFAULT_PORT) == CURLUE_OK;
+    if (ok) {
+        host = hostPart;
+        std::transform(host.begin(), host.end(), host.begin(), ::tolower);
+        port = std::atol(portPart);
+    }
+    curl_free(hostPart);
+    curl_free(portPart);
+    curl_url_cleanup(handle);
+    return ok;
+}
+
+/**
+ * @brief Checks whether a host is an IP address literal, which needs no lookup
+ *
+ * @param host Host name
+ * @return true if the host is an IPv4 or (bracketed) IPv6 address
+ */
+bool isAddress(const std::string& host) {
+    unsigned char buffer[sizeof(struct in6_addr)];
+    std::string bare = host;
+    if (bare.size() > 2 && bare.front() == '[' && bare.back() == ']') {
+        bare = bare.substr(1, bare.size() - 2);
+    }
+    return inet_pton(AF_INET, bare.c_str(), buffer) == 1 ||
+           inet_pton(AF_INET6, bare.c_str(), buffer) == 1;
+}
+
+/**
+ * @brief Looks a host name up
+ *
+ * @param host Host name
+ * @return Addresses of the host (IPv6 ones enclosed in brackets), empty if
+ *         the lookup failed
+ */
+std::vector<std::string> resolve(const std::string& host) {
+    std::vector<std::string> addresses;
+    struct addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* result = nullptr;
+    if (getaddrinfo(host.c_str(), nullptr, &hints, &result) != 0) return addresses;
+
+    for (struct addrinfo* ai = result; ai; ai = ai->ai_next) {
+        char text[INET6_ADDRSTRLEN];
+        std::string address;
+        if (ai->ai_family == AF_INET &&
+            inet_ntop(AF_INET, &((struct sockaddr_in*)ai->ai_addr)->sin_addr, text, sizeof(text))) {
+            address = text;
+        } else if (ai->ai_family == AF_INET6 &&
+                   inet_ntop(AF_INET6, &((struct sockaddr_in6*)ai->ai_addr)->sin6_addr, text,
+                             sizeof(text))) {
+            address = "[" + std::string(text) + "]";
+        }
+        if (!address.empty() &&
+            std::find(addresses.begin(), addresses.end(), address) == addresses.end()) {
+            addresses.push_back(address);
+        }
+    }
+    freeaddrinfo(result);
+    return addresses;
+}
+
+}  // namespace
+
+DnsCache& DnsCache::instance() {
+    static DnsCache cache;
+    return cache;
+}
+
+DnsCache::~DnsCache() {
+    for (auto& [host, entry] : entries_) {
+        for (auto& [port, list] : entry.lists) curl_slist_free_all(list);
+    }
+    for (struct curl_slist* list : retired_) curl_slist_free_all(list);
+}
+
+void DnsCache::prefetch(const std::vector<std::string>& urls) {
+    std::set<std::string> hosts;
+    auto now = std::chrono::system_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const std::string& url : urls) {
+            std::string host;
+            long port;
+            if (!hostAndPort(url, host, port) || isAddress(host)) continue;
+            auto found = entries_.find(host);
+            if (found == entries_.end() || found->second.expires <= now) hosts.insert(host);
+        }
+    }
+
+    // Each worker takes the next host to look up, so that a batch with
+    // hundreds of hosts does not start hundreds of threads
+    std::vector<std::string> pending(hosts.begin(), hosts.end());
+    std::atomic<size_t> next{0};
+    auto lookUp = [this, &pending, &next] {
+        for (size_t i = next++; i < pending.size(); i = next++) {
+            Entry entry;
+            entry.addresses = resolve(pending[i]);
+            if (entry.addresses.empty()) continue;
+            entry.expires = std::chrono::system_clock::now() + std::chrono::seconds(DNS_CACHE_TTL);
+            store(pending[i], entry);
+        }
+    };
+    std::vector<std::thread> workers;
+    size_t count = std::min<size_t>(pending.size(), DNS_CACHE_MAX_LOOKUPS);
+    for (size_t i = 1; i < count; i++) workers.emplace_back(lookUp);
+    lookUp();
+    for (std::thread& worker : workers) worker.join();
+}
+
+void DnsCache::apply(CURL* curl, const std::string& url) {
+    std::string host;
+    long port;
+    if (!hostAndPort(url, host, port)) return;
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(host);
+    if (found == entries_.end() || found->second.expires <= std::chrono::system_clock::now()) {
+        return;
+    }
+    Entry& entry = found->second;
+    struct curl_slist*& list = entry.lists[port];
+    if (!list) {
+        std::string addresses;
+        for (const std::string& address : entry.addresses) {
+            addresses += (addresses.empty() ? "" : ",") + address;
+        }
+        std::string item = host + ":" + std::to_string(port) + ":" + addresses;
+        list = curl_slist_append(nullptr, item.c_str());
+    }
+    curl_easy_setopt(curl, CURLOPT_RESOLVE, list);
+}
+
+void DnsCache::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) return;
+    try {
+        json cache = json::parse(in);
+        auto now = std::chrono::system_clock::now();
+        for (auto& [host, value] : cache.items()) {
+            Entry entry;
+            entry.addresses = value.at("addresses").get<std::vector<std::string>>();
+            entry.expires = std::chrono::system_clock::from_time_t(
+                value.at("expires").get<std::time_t>());
+            if (entry.expires > now && !entry.addresses.empty()) store(host, entry);
+        }
+    } catch (std::exception&) {
+        // A corrupt cache file is ignored; the hosts are resolved again
+    }
+}
+
+void DnsCache::save(const std::string& filename) const {
+    json cache = json::object();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto now = std::chrono::system_clock::now();
+        for (const auto& [host, entry] : entries_) {
+            if (entry.expires <= now) continue;
+            cache[host] = {{"addresses", entry.addresses},
+                           {"expires", std::chrono::system_clock::to_time_t(entry.expires)}};
+        }
+    }
+    std::ofstream out(filename, std::ios::trunc);
+    if (out) out << cache.dump(2) << std::endl;
+}
+
+/**
+ * @brief Adds or replaces the entry of a host
+ * @details Lists of a replaced entry may still be in use by easy handles,
+ *          so they are only released with the cache
+ *
+ * @param host Host name
+ * @param entry Addresses of the host
+ */
+void DnsCache::store(const std::string& host, const Entry& entry) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto found = entries_.find(host);
+    if (found != entries_.end()) {
+        for (auto& [port, list] : found->second.lists) retired_.push_back(list);
+    }
+    entries_[host] = entry;
+    entries_[host].lists.clear();
+}
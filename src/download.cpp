@@ -0,0 +1,920 @@
+/**
+ * @file	download.cpp
+ * @brief	Functions to download images from their URLs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "download.h"
+
+#include <curl/curl.h>
+#include <fcntl.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "dnscache.h"
+#include "log.h"
+#include "probes.h"
+#include "task.h"
+#include "tlscache.h"
+
+namespace {
+
+/** @brief Information about a remote file obtained before downloading it */
+struct RemoteInfo {
+    std::string effectiveUrl;   ///< URL after following redirects
+    curl_off_t length = -1;     ///< Content-Length, or -1 if unknown
+    bool acceptRanges = false;  ///< Whether the host serves byte ranges
+    std::string etag;           ///< ETag header, if any
+    std::string lastModified;   ///< Last-Modified header, if any
+    std::vector<std::string> headers;  ///< All headers, for diagnostics
+
+    /** @brief Validator to send in If-Range (a strong ETag is preferred) */
+    std::string validator() const {
+        if (!etag.empty() && etag.compare(0, 2, "W/") != 0) return etag;
+        return lastModified;
+    }
+};
+
+/** @brief A byte range of a file downloaded by its own request */
+struct Segment {
+    curl_off_t start = 0;   ///< First byte of the range
+    curl_off_t offset = 0;  ///< Next offset to write at
+    curl_off_t end = -1;    ///< Last byte of the range (inclusive), -1 if unknown
+
+    int fd = -1;                           ///< Descriptor of the part file
+    curl_off_t* received = nullptr;        ///< Counter of bytes received by the engine
+    CURL* curl = nullptr;                  ///< Easy handle of the current attempt
+    struct curl_slist* headers = nullptr;  ///< Request headers of the current attempt
+    std::string range;                     ///< Requested range of the current attempt
+    bool checked = false;                  ///< Whether the response status was checked
+    bool stale = false;                    ///< Whether the validator no longer matches
+
+    /** @brief Whether all bytes of the range were written */
+    bool done() const { return end >= 0 && offset > end; }
+};
+
+}  // namespace
+
+/** @brief State of a download, persisted between attempts and runs */
+struct Download {
+    uint64_t id = 0;                ///< Number of the image
+    std::string url;                ///< URL to the image
+    std::string host;               ///< Host of the URL
+    std::string filename;           ///< Name of the file for the downloaded image
+    std::string partFile;           ///< File receiving the body until completion
+    std::string stateFile;          ///< Sidecar file recording the progress
+    DownloadCallback callback;      ///< Function called when the download finishes
+    RemoteInfo info;                ///< Information about the remote file
+    std::vector<Segment> segments;  ///< Ranges of the body
+
+    CURL* probe = nullptr;          ///< Easy handle of the HEAD request
+    int fd = -1;                    ///< Descriptor of the part file
+    int attempt = 0;                ///< Number of the current attempt
+    int inFlight = 0;               ///< Requests of the current attempt in progress
+    bool waiting = false;           ///< Whether the next attempt is pending
+    bool finished = false;          ///< Whether the download finished
+    curl_off_t bytes = 0;           ///< Bytes received by all requests
+    RequestTiming probeTiming;      ///< Timing of the last HEAD request
+    RequestTiming slowest;          ///< Timing of the slowest request of the body
+    std::chrono::steady_clock::time_point submittedAt;  ///< Time it was submitted
+    std::chrono::steady_clock::time_point startedAt;    ///< Time it left the queue
+    std::chrono::steady_clock::time_point retryAt;      ///< Time of the next attempt
+    std::chrono::steady_clock::time_point lastSave;     ///< Time the progress was recorded
+
+    /** @brief Whether an interrupted transfer can continue from its last byte */
+    bool resumable() const { return info.acceptRanges && !info.validator().empty(); }
+};
+
+namespace {
+
+/**
+ * @brief Retrieves the host of a URL
+ *
+ * @param url URL
+ * @return Host name (in lowercase), or an empty string if the URL is invalid
+ */
+std::string hostOf(const std::string& url) {
+    std::string host;
+    CURLU* handle = curl_url();
+    char* part = nullptr;
+    if (handle && curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_HOST, &part, 0) == CURLUE_OK) {
+        host = part;
+        std::transform(host.begin(), host.end(), host.begin(), ::tolower);
+        curl_free(part);
+    }
+    curl_url_cleanup(handle);
+    return host;
+}
+
+/**
+ * @brief Checks whether a header line has a given (case-insensitive) name
+ *        and retrieves its trimmed value
+ *
+ * @param line Header line
+ * @param name Header name followed by a colon
+ * @param value Header value, if the name matches
+ * @return true if the header line has the given name, false otherwise
+ */
+bool headerValue(const std::string& line, const std::string& name, std::string& value) {
+    if (line.size() <= name.size() ||
+        strncasecmp(line.c_str(), name.c_str(), name.size()) != 0) {
+        return false;
+    }
+    size_t first = line.find_first_not_of(" \t", name.size());
+    size_t last = line.find_last_not_of(" \t\r\n");
+    value = (first == std::string::npos || last < first)
+                ? "" : line.substr(first, last - first + 1);
+    return true;
+}
+
+/**
+ * @brief A header callback for libcurl collecting the headers relevant to
+ *        segmented and resumable downloads
+ *
+ * @param buffer Header line (not null-terminated)
+ * @param size Always 1
+ * @param num_items Length of the header line
+ * @param userp Pointer to the RemoteInfo being filled
+ * @return Number of bytes handled (size * num_items)
+ */
+size_t probeHeaderCallback(char* buffer, size_t size, size_t num_items, void* userp) {
+    TaskScope task(Task::Probe);
+    RemoteInfo* info = (RemoteInfo*)userp;
+    std::string line(buffer, size * num_items);
+    std::string value;
+    if (line.compare(0, 5, "HTTP/") == 0) {
+        // Headers of an earlier response in a redirect chain are discarded
+        info->acceptRanges = false;
+        info->etag.clear();
+        info->lastModified.clear();
+        info->headers.clear();
+    } else if (headerValue(line, "accept-ranges:", value)) {
+        info->acceptRanges = value.find("bytes") != std::string::npos;
+    } else if (headerValue(line, "etag:", value)) {
+        info->etag = value;
+    } else if (headerValue(line, "last-modified:", value)) {
+        info->lastModified = value;
+    }
+    // Every header is also kept as is, for diagnostics
+    size_t last = line.find_last_not_of("\r\n");
+    if (last != std::string::npos) info->headers.push_back(line.substr(0, last + 1));
+    return size * num_items;
+}
+
+/**
+ * @brief Retrieves the timing breakdown of a finished request
+ *
+ * @param curl Easy handle of the request
+ * @param result Result of the transfer
+ * @return Timing of the request
+ */
+RequestTiming timingOf(CURL* curl, CURLcode result) {
+    auto seconds = [curl](CURLINFO info) {
+        curl_off_t micros = 0;
+        curl_easy_getinfo(curl, info, &micros);
+        return micros / 1e6;
+    };
+    RequestTiming timing;
+    timing.nameLookup = seconds(CURLINFO_NAMELOOKUP_TIME_T);
+    timing.connect = seconds(CURLINFO_CONNECT_TIME_T);
+    timing.tlsHandshake = seconds(CURLINFO_APPCONNECT_TIME_T);
+    timing.preTransfer = seconds(CURLINFO_PRETRANSFER_TIME_T);
+    timing.firstByte = seconds(CURLINFO_STARTTRANSFER_TIME_T);
+    timing.total = seconds(CURLINFO_TOTAL_TIME_T);
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &timing.status);
+    curl_easy_getinfo(curl, CURLINFO_HTTP_VERSION, &timing.httpVersion);
+    if (result != CURLE_OK) timing.error = curl_easy_strerror(result);
+    return timing;
+}
+
+/**
+ * @brief Splits the body of a remote file into the ranges to download
+ * @details Large bodies on hosts serving byte ranges are split into
+ *          SEGMENTED_DOWNLOAD_SEGMENTS ranges of (almost) the same size;
+ *          other bodies are downloaded as a single range
+ *
+ * @param info Information about the remote file
+ * @return Ranges of the body
+ */
+std::vector<Segment> planSegments(const RemoteInfo& info) {
+    if (!info.acceptRanges || info.length <= SEGMENTED_DOWNLOAD_THRESHOLD) {
+        std::vector<Segment> segments(1);
+        segments[0].end = info.length > 0 ? info.length - 1 : -1;
+        return segments;
+    }
+    std::vector<Segment> segments(SEGMENTED_DOWNLOAD_SEGMENTS);
+    curl_off_t chunk = info.length / SEGMENTED_DOWNLOAD_SEGMENTS;
+    for (size_t i = 0; i < segments.size(); i++) {
+        segments[i].start = segments[i].offset = (curl_off_t)i * chunk;
+        segments[i].end = (i + 1 == segments.size()) ? info.length - 1
+                                                     : segments[i].start + chunk - 1;
+    }
+    return segments;
+}
+
+/**
+ * @brief Records the progress of a download into its sidecar file
+ *
+ * @param download Download to record
+ */
+void saveState(const Download& download) {
+    json segments = json::array();
+    for (const Segment& segment : download.segments) {
+        segments.push_back({{"start", segment.start},
+                            {"offset", segment.offset},
+                            {"end", segment.end}});
+    }
+    json state = {{"url", download.url},
+                  {"validator", download.info.validator()},
+                  {"length", download.info.length},
+                  {"segments", segments}};
+
+    // Write to a temporary file first so that a crash never leaves a torn
+    // state, without following a symbolic link planted in its place
+    std::string tmpFile = download.stateFile + ".tmp";
+    int fd = open(tmpFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW | O_CLOEXEC, 0644);
+    if (fd < 0) return;
+    std::string text = state.dump();
+    bool written = write(fd, text.data(), text.size()) == (ssize_t)text.size();
+    if (::close(fd) == 0 && written) std::rename(tmpFile.c_str(), download.stateFile.c_str());
+}
+
+/**
+ * @brief Restores the progress of an earlier, interrupted download
+ * @details The progress is only restored if the earlier download refers
+ *          to the same URL and the remote file still has the same length
+ *          and validator, which is also checked by the host via If-Range
+ *
+ * @param download Download to restore, already probed
+ * @return true if the progress was restored, false otherwise
+ */
+bool loadState(Download& download) {
+    std::ifstream in(download.stateFile);
+    if (!in) return false;
+    try {
+        json state = json::parse(in);
+        if (state.at("url").get<std::string>() != download.url ||
+            state.at("validator").get<std::string>() != download.info.validator() ||
+            state.at("length").get<curl_off_t>() != download.info.length) {
+            return false;
+        }
+        std::vector<Segment> segments;
+        for (const json& entry : state.at("segments")) {
+            Segment segment;
+            segment.start = entry.at("start").get<curl_off_t>();
+            segment.offset = entry.at("offset").get<curl_off_t>();
+            segment.end = entry.at("end").get<curl_off_t>();
+            segments.push_back(segment);
+        }
+        if (segments.empty()) return false;
+        download.segments = segments;
+        return true;
+    } catch (std::exception&) {
+        return false;
+    }
+}
+
+/**
+ * @brief A write callback for libcurl storing the body of a range at its
+ *        offset of the part file
+ * @details The transfer is aborted (by handling fewer bytes than received)
+ *          if the host answers a range request with 200 OK, which happens
+ *          when the remote file changed and its validator no longer matches
+ *          If-Range, or if it sends more bytes than requested
+ *
+ * @param contents Pointer to the block of data received from the HTTP response
+ * @param size The size (in bytes) of each data element
+ * @param num_data The number of data elements
+ * @param userp Pointer to the Segment being downloaded
+ * @return Number of bytes handled
+ */
+size_t segmentWriteCallback(void* contents, size_t size, size_t num_data, void* userp) {
+    Segment* segment = (Segment*)userp;
+    size_t total = size * num_data;
+
+    if (!segment->checked) {
+        long response_code = 0;
+        curl_easy_getinfo(segment->curl, CURLINFO_RESPONSE_CODE, &response_code);
+        if (response_code == 200 && !segment->range.empty()) {
+            segment->stale = true;
+            return 0;
+        }
+        if (response_code != (segment->range.empty() ? 200 : 206)) return 0;
+        segment->checked = true;
+    }
+    if (segment->end >= 0 && segment->offset + (curl_off_t)total > segment->end + 1) {
+        return 0;
+    }
+
+    const char* data = (const char*)contents;
+    size_t written = 0;
+    while (written < total) {
+        ssize_t n = pwrite(segment->fd, data + written, total - written,
+                           segment->offset + written);
+        if (n <= 0) break;
+        written += n;
+    }
+    segment->offset += written;
+    if (segment->received) *segment->received += written;
+    return written;
+}
+
+/**
+ * @brief Prepares the request of a segment for the next attempt
+ *
+ * @param download Download the segment belongs to
+ * @param segment Segment to request
+ * @return true if the request is ready, false otherwise
+ */
+bool prepareSegment(Download& download, Segment& segment) {
+    segment.fd = download.fd;
+    segment.checked = false;
+    segment.stale = false;
+    segment.curl = curl_easy_init();
+    if (!segment.curl) return false;
+
+    // A range is only requested if the segment does not start at the first
+    // byte of the body or is not the whole body
+    bool whole = segment.offset == 0 &&
+                 (segment.end < 0 || segment.end == download.info.length - 1);
+    segment.range.clear();
+    if (!whole) {
+        segment.range = std::to_string(segment.offset) + "-" +
+                        (segment.end >= 0 ? std::to_string(segment.end) : "");
+        std::string validator = download.info.validator();
+        if (!validator.empty()) {
+            segment.headers = curl_slist_append(nullptr, ("If-Range: " + validator).c_str());
+        }
+    }
+
+    curl_easy_setopt(segment.curl, CURLOPT_URL, download.info.effectiveUrl.c_str());
+    if (!segment.range.empty()) {
+        curl_easy_setopt(segment.curl, CURLOPT_RANGE, segment.range.c_str());
+    }
+    curl_easy_setopt(segment.curl, CURLOPT_HTTPHEADER, segment.headers);
+    curl_easy_setopt(segment.curl, CURLOPT_WRITEFUNCTION, segmentWriteCallback);
+    curl_easy_setopt(segment.curl, CURLOPT_WRITEDATA, &segment);
+    curl_easy_setopt(segment.curl, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(segment.curl, CURLOPT_PRIVATE, &download);
+    // Abort stalled transfers (less than 1 KB/s for 30 s) so they can be resumed
+    curl_easy_setopt(segment.curl, CURLOPT_LOW_SPEED_LIMIT, 1024L);
+    curl_easy_setopt(segment.curl, CURLOPT_LOW_SPEED_TIME, 30L);
+    return true;
+}
+
+/**
+ * @brief Releases the request of a segment after an attempt
+ *
+ * @param segment Segment to release
+ */
+void releaseSegment(Segment& segment) {
+    curl_easy_cleanup(segment.curl);
+    curl_slist_free_all(segment.headers);
+    segment.curl = nullptr;
+    segment.headers = nullptr;
+}
+
+/**
+ * @brief Discards the progress of a download so that it starts over
+ *
+ * @param download Download to restart
+ */
+void restart(Download& download) {
+    download.segments = planSegments(download.info);
+    // Preallocate the whole body; otherwise, the file grows as ranges are written
+    if (ftruncate(download.fd, 0) == 0 && download.info.length > 0) {
+        posix_fallocate(download.fd, 0, download.info.length);
+    }
+    std::remove(download.stateFile.c_str());
+}
+
+}  // namespace
+
+DownloadEngine::DownloadEngine() : DownloadEngine(Options()) {}
+
+DownloadEngine::DownloadEngine(const Options& options) : options_(options) {
+    window_ = options_.autoTune ? std::min(options_.initialConcurrent, options_.maxConcurrent)
+                                : options_.maxConcurrent;
+    window_ = std::max(window_, 1.0);
+    windowSize_ = (size_t)window_;
+    epochStart_ = Clock::now();
+    multi_ = curl_multi_init();
+    curl_multi_setopt(multi_, CURLMOPT_PIPELINING,
+                      options_.http2 ? CURLPIPE_MULTIPLEX : CURLPIPE_NOTHING);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, options_.maxHostConnections);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_CONCURRENT_STREAMS, options_.maxHostStreams);
+}
+
+DownloadEngine::~DownloadEngine() {
+    for (auto& download : active_) {
+        if (download->probe) {
+            curl_multi_remove_handle(multi_, download->probe);
+            curl_easy_cleanup(download->probe);
+        }
+        for (Segment& segment : download->segments) {
+            if (!segment.curl) continue;
+            curl_multi_remove_handle(multi_, segment.curl);
+            releaseSegment(segment);
+        }
+        if (download->fd >= 0) ::close(download->fd);
+    }
+    curl_multi_cleanup(multi_);
+}
+
+void DownloadEngine::submit(const std::string& url, const std::string& filename,
+                            DownloadCallback callback, uint64_t id) {
+    auto download = std::make_unique<Download>();
+    download->id = id;
+    download->url = url;
+    download->host = hostOf(url);
+    download->filename = filename;
+    download->partFile = filename + ".part";
+    download->stateFile = filename + ".part.json";
+    download->callback = callback;
+    download->submittedAt = Clock::now();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        submitted_.push_back(std::move(download));
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void DownloadEngine::close() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+    }
+    curl_multi_wakeup(multi_);
+}
+
+void DownloadEngine::run() {
+    TaskScope task(Task::Download);
+    while (true) {
+        bool closed;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (auto& download : submitted_) enqueue(std::move(download));
+            submitted_.clear();
+            closed = closed_;
+        }
+
+        auto now = Clock::now();
+        int timeout = 1000;
+        while (active_.size() < (size_t)window_) {
+            std::unique_ptr<Download> download = nextQueued(now, timeout);
+            if (!download) break;
+            PROBE_START(download, download->id, 0);
+            active_.push_back(std::move(download));
+            startProbe(*active_.back());
+        }
+        inFlight_.store(active_.size(), std::memory_order_relaxed);
+        if (options_.autoTune) tune(now);
+
+        // Start the attempts whose backoff expired and record the progress
+        // of resumable transfers every second
+        for (auto& download : active_) {
+            if (download->waiting) {
+                if (download->retryAt <= now) {
+                    startAttempt(*download);
+                } else {
+                    auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                        download->retryAt - now);
+                    timeout = std::min(timeout, (int)wait.count() + 1);
+                }
+            } else if (download->inFlight > 0 && download->resumable() &&
+                       now - download->lastSave >= std::chrono::seconds(1)) {
+                saveState(*download);
+                download->lastSave = now;
+            }
+        }
+
+        int running = 0;
+        if (curl_multi_perform(multi_, &running) != CURLM_OK) break;
+
+        CURLMsg* msg;
+        int messages;
+        while ((msg = curl_multi_info_read(multi_, &messages))) {
+            if (msg->msg != CURLMSG_DONE) continue;
+            CURL* curl = msg->easy_handle;
+            CURLcode result = msg->data.result;
+            Download* download = nullptr;
+            curl_easy_getinfo(curl, CURLINFO_PRIVATE, (char**)&download);
+            curl_multi_remove_handle(multi_, curl);
+            recordRequest(curl, result);
+
+            if (curl == download->probe) {
+                download->probeTiming = timingOf(curl, result);
+                long response_code = 0;
+                if (result == CURLE_OK) {
+                    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+                }
+                if (response_code == 200) {
+                    char* effective = nullptr;
+                    curl_easy_getinfo(curl, CURLINFO_EFFECTIVE_URL, &effective);
+                    if (effective) download->info.effectiveUrl = effective;
+                    curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T,
+                                      &download->info.length);
+                } else {
+                    // Only the headers are kept, to diagnose the failure
+                    std::vector<std::string> headers = std::move(download->info.headers);
+                    download->info = RemoteInfo();
+                    download->info.effectiveUrl = download->url;
+                    download->info.headers = std::move(headers);
+                }
+                PROBE_DONE(probe, download->id, std::max<curl_off_t>(download->info.length, 0),
+                           response_code == 200);
+                curl_easy_cleanup(curl);
+                download->probe = nullptr;
+                finishProbe(*download);
+                continue;
+            }
+
+            curl_off_t received = 0;
+            curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+            download->bytes += received;
+            RequestTiming timing = timingOf(curl, result);
+            if (timing.total >= download->slowest.total) download->slowest = timing;
+            for (Segment& segment : download->segments) {
+                if (segment.curl != curl) continue;
+                // Transfers of unknown length end when the host closes the body
+                if (result == CURLE_OK && segment.end < 0) segment.end = segment.offset - 1;
+                releaseSegment(segment);
+            }
+            if (--download->inFlight == 0) finishAttempt(*download);
+        }
+
+        size_t before = active_.size();
+        active_.erase(std::remove_if(active_.begin(), active_.end(),
+                                     [](const std::unique_ptr<Download>& download) {
+                                         return download->finished;
+                                     }),
+                      active_.end());
+        inFlight_.store(active_.size(), std::memory_order_relaxed);
+        size_t queued;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            queued = queued_;
+        }
+        if (closed && active_.empty() && queued == 0) break;
+        // Start queued downloads right away if others finished
+        if (active_.size() < before && queued > 0) continue;
+
+        if (curl_multi_poll(multi_, nullptr, 0, timeout, nullptr) != CURLM_OK) break;
+    }
+}
+
+std::vector<HostMetrics> DownloadEngine::hostMetrics() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<HostMetrics> metrics;
+    for (const std::string& name : hostOrder_) {
+        const Host& host = hosts_.at(name);
+        HostMetrics entry;
+        entry.host = name.empty() ? "(invalid)" : name;
+        entry.queued = host.queue.size();
+        entry.active = host.active;
+        entry.completed = host.completed;
+        entry.failed = host.failed;
+        entry.bytes = host.bytes;
+        size_t started = host.active + host.completed + host.failed;
+        if (started > 0) entry.meanWait = host.waitSum / started;
+        if (!host.latencies.empty()) {
+            std::vector<double> latencies = host.latencies;
+            std::sort(latencies.begin(), latencies.end());
+            double sum = 0;
+            for (double latency : latencies) sum += latency;
+            entry.meanLatency = sum / latencies.size();
+            entry.p95Latency = latencies[(latencies.size() - 1) * 95 / 100];
+            entry.maxLatency = latencies.back();
+        }
+        metrics.push_back(entry);
+    }
+    return metrics;
+}
+
+/**
+ * @brief Appends a download to the queue of its host
+ * @details It must be called with mutex_ locked
+ *
+ * @param download Download to enqueue
+ */
+void DownloadEngine::enqueue(std::unique_ptr<Download> download) {
+    auto found = hosts_.find(download->host);
+    if (found == hosts_.end()) {
+        found = hosts_.emplace(download->host, Host()).first;
+        hostOrder_.push_back(download->host);
+    }
+    found->second.queue.push_back(std::move(download));
+    queued_++;
+}
+
+/**
+ * @brief Takes the next download to start, serving the hosts in round-robin
+ * @details Hosts with maxHostActive downloads in progress or that started
+ *          a download less than hostDelay ago are skipped
+ *
+ * @param now Current time
+ * @param timeout Time (in milliseconds) to wait for events, shortened to
+ *        the end of the delay of a skipped host
+ * @return Download to start, or nullptr if no host can start one now
+ */
+std::unique_ptr<Download> DownloadEngine::nextQueued(Clock::time_point now, int& timeout) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (size_t n = 0; n < hostOrder_.size(); n++) {
+        size_t index = (nextHost_ + n) % hostOrder_.size();
+        Host& host = hosts_[hostOrder_[index]];
+        if (host.queue.empty() || host.active >= options_.maxHostActive) continue;
+        if (host.nextStart > now) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+                host.nextStart - now);
+            timeout = std::min(timeout, (int)wait.count() + 1);
+            continue;
+        }
+
+        std::unique_ptr<Download> download = std::move(host.queue.front());
+        host.queue.pop_front();
+        queued_--;
+        host.active++;
+        host.nextStart = now + options_.hostDelay;
+        download->startedAt = now;
+        host.waitSum += std::chrono::duration<double>(now - download->submittedAt).count();
+        nextHost_ = (index + 1) % hostOrder_.size();
+        return download;
+    }
+    return nullptr;
+}
+
+/**
+ * @brief Retrieves the size of a remote file, its validators and whether
+ *        its host serves byte ranges through an HTTP HEAD request
+ *
+ * @param download Download to probe
+ */
+void DownloadEngine::startProbe(Download& download) {
+    download.info = RemoteInfo();
+    download.info.effectiveUrl = download.url;
+    PROBE_START(probe, download.id, 0);
+    download.probe = curl_easy_init();
+    if (!download.probe) {
+        PROBE_DONE(probe, download.id, 0, false);
+        finishProbe(download);
+        return;
+    }
+    configure(download.probe);
+    curl_easy_setopt(download.probe, CURLOPT_URL, download.url.c_str());
+    DnsCache::instance().apply(download.probe, download.url);
+    curl_easy_setopt(download.probe, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(download.probe, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(download.probe, CURLOPT_TIMEOUT, 30L);
+    curl_easy_setopt(download.probe, CURLOPT_HEADERFUNCTION, probeHeaderCallback);
+    curl_easy_setopt(download.probe, CURLOPT_HEADERDATA, &download.info);
+    curl_easy_setopt(download.probe, CURLOPT_PRIVATE, &download);
+    curl_multi_add_handle(multi_, download.probe);
+}
+
+/**
+ * @brief Opens the part file of a probed download, restoring the progress
+ *        of an earlier run if possible, and starts its first attempt
+ *
+ * @param download Probed download
+ */
+void DownloadEngine::finishProbe(Download& download) {
+    if (download.attempt > 0) {
+        // Probed again because the remote file changed during an attempt
+        restart(download);
+        download.waiting = true;
+        return;
+    }
+    // A symbolic link planted in place of the part file is never followed
+    download.fd = open(download.partFile.c_str(), O_WRONLY | O_CREAT | O_NOFOLLOW | O_CLOEXEC,
+                       0644);
+    if (download.fd < 0) {
+        LOG_ERROR("unable to create " << download.partFile << " file");
+        finish(download, false);
+        return;
+    }
+    if (!download.resumable() || !loadState(download)) restart(download);
+    startAttempt(download);
+}
+
+/**
+ * @brief Requests the pending segments of a download concurrently
+ *
+ * @param download Download to perform
+ */
+void DownloadEngine::startAttempt(Download& download) {
+    download.waiting = false;
+    download.attempt++;
+    download.lastSave = Clock::now();
+    for (Segment& segment : download.segments) {
+        if (segment.done()) continue;
+        if (prepareSegment(download, segment)) {
+            segment.received = &received_;
+            configure(segment.curl);
+            DnsCache::instance().apply(segment.curl, download.info.effectiveUrl);
+            curl_multi_add_handle(multi_, segment.curl);
+            download.inFlight++;
+        }
+    }
+    if (download.inFlight == 0) finishAttempt(download);
+}
+
+/**
+ * @brief Completes a download whose segments were all downloaded or
+ *        schedules its next attempt
+ *
+ * @param download Download whose attempt finished
+ */
+void DownloadEngine::finishAttempt(Download& download) {
+    bool complete = true;
+    bool stale = false;
+    for (const Segment& segment : download.segments) {
+        complete = complete && segment.done();
+        stale = stale || segment.stale;
+    }
+    if (complete) {
+        ::close(download.fd);
+        download.fd = -1;
+        std::remove(download.stateFile.c_str());
+        finish(download, std::rename(download.partFile.c_str(), download.filename.c_str()) == 0);
+        return;
+    }
+
+    if (download.attempt >= DOWNLOAD_MAX_ATTEMPTS) {
+        // The part file and its sidecar are kept to resume the download in a later run
+        ::close(download.fd);
+        download.fd = -1;
+        if (download.resumable()) {
+            saveState(download);
+        } else {
+            std::remove(download.partFile.c_str());
+            std::remove(download.stateFile.c_str());
+        }
+        finish(download, false);
+        return;
+    }
+
+    download.retryAt = Clock::now() +
+                       std::chrono::seconds(download.attempt);
+    if (stale) {
+        // The remote file changed since the download started
+        startProbe(download);
+        return;
+    }
+    if (download.resumable()) {
+        saveState(download);
+    } else {
+        // Without byte ranges, a retry has to download the whole body again
+        restart(download);
+    }
+    download.waiting = true;
+}
+
+/**
+ * @brief Marks a download as finished and notifies its callback
+ *
+ * @param download Finished download
+ * @param ok Whether the image was downloaded
+ */
+void DownloadEngine::finish(Download& download, bool ok) {
+    download.finished = true;
+    DownloadResult result;
+    result.url = download.url;
+    result.filename = download.filename;
+    result.ok = ok;
+    result.bytes = download.bytes;
+    result.wait = std::chrono::duration<double>(download.startedAt - download.submittedAt).count();
+    result.seconds = std::chrono::duration<double>(Clock::now() - download.startedAt).count();
+    result.attempts = download.attempt;
+    result.effectiveUrl = download.info.effectiveUrl;
+    result.headers = download.info.headers;
+    result.probe = download.probeTiming;
+    result.slowest = download.slowest;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        Host& host = hosts_[download.host];
+        host.active--;
+        (ok ? host.completed : host.failed)++;
+        host.bytes += download.bytes;
+        host.latencies.push_back(result.seconds);
+    }
+    PROBE_DONE(download, download.id, download.bytes, ok);
+    if (download.callback) download.callback(result);
+}
+
+/**
+ * @brief Applies the settings shared by every request of the engine
+ *
+ * @param curl Easy handle to configure
+ */
+void DownloadEngine::configure(CURL* curl) const {
+    // Downloads are idempotent GET/HEAD requests, which may be sent as early data
+    TlsSessionCache::instance().apply(curl, true);
+    if (options_.http2) {
+        curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, (long)CURL_HTTP_VERSION_2TLS);
+        // Wait for a connection to the host to multiplex on rather than
+        // opening a new one
+        curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L);
+    }
+}
+
+/**
+ * @brief Accounts a finished request in the current AIMD epoch
+ * @details Failed transfers and 429 (Too Many Requests) or 5xx answers are
+ *          congestion signals
+ *
+ * @param curl Easy handle of the request
+ * @param result Result of the transfer
+ */
+void DownloadEngine::recordRequest(CURL* curl, CURLcode result) {
+    long response_code = 0;
+    curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+    epochRequests_++;
+    if (result == CURLE_OPERATION_TIMEDOUT) epochTimeouts_++;
+    if (result != CURLE_OK || response_code == 429 || response_code >= 500) epochErrors_++;
+}
+
+/**
+ * @brief Adjusts the window at the end of each AIMD epoch
+ * @details Epochs in which the window did not limit the downloads (i.e.,
+ *          fewer images were queued than the window allowed) say nothing
+ *          about the throughput curve and leave the window unchanged. The
+ *          decisions are logged to the standard error
+ *
+ * @param now Current time
+ */
+void DownloadEngine::tune(Clock::time_point now) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (queued_ > 0 && active_.size() >= (size_t)window_) epochLimited_ = true;
+    }
+    double elapsed = std::chrono::duration<double>(now - epochStart_).count();
+    if (now - epochStart_ < options_.tuneInterval || elapsed <= 0) return;
+
+    double goodput = (received_ - epochReceived_) / elapsed;
+    double errorRate = epochRequests_ > 0 ? (double)epochErrors_ / epochRequests_ : 0;
+    double previous = window_;
+    const char* reason = nullptr;
+    if (epochErrors_ > 0 && (epochTimeouts_ > 0 || errorRate > 0.1)) {
+        window_ = std::max(1.0, window_ * 0.5);
+        reason = epochTimeouts_ > 0 ? "timeouts" : "errors";
+    } else if (epochLimited_ && lastGoodput_ > 0 && goodput < lastGoodput_ * 0.9) {
+        window_ = std::max(1.0, window_ * 0.75);
+        reason = "goodput dropped";
+    } else if (epochLimited_ && goodput >= lastGoodput_ * 1.05) {
+        window_ = std::min((double)options_.maxConcurrent, window_ + 1);
+        reason = "goodput improved";
+    }
+    if (reason && (size_t)window_ != (size_t)previous) {
+        LOG_INFO("Download window " << (size_t)previous << " -> " << (size_t)window_
+                  << " (" << reason << "; goodput " << goodput / 1024 << " KB/s, "
+                  << epochErrors_ << "/" << epochRequests_ << " requests failed)");
+    }
+
+    windowSize_.store((size_t)window_, std::memory_order_relaxed);
+    if (epochLimited_ || reason) lastGoodput_ = goodput;
+    epochStart_ = now;
+    epochReceived_ = received_;
+    epochRequests_ = epochErrors_ = epochTimeouts_ = 0;
+    epochLimited_ = false;
+}
+
+void printHostMetrics(const std::vector<HostMetrics>& metrics, std::ostream& out) {
+    out << "Downloads per host (queued, active, completed, failed, KB, "
+        << "mean wait, mean/p95/max latency in seconds):" << std::endl;
+    for (const HostMetrics& entry : metrics) {
+        out << "  " << entry.host << ": " << entry.queued << ", " << entry.active << ", "
+            << entry.completed << ", " << entry.failed << ", " << entry.bytes / 1024 << ", "
+            << entry.meanWait << ", " << entry.meanLatency << "/" << entry.p95Latency
+            << "/" << entry.maxLatency << std::endl;
+    }
+}
+
+bool downloadImage(const std::string& url, const std::string& filename) {
+    bool ok = false;
+    DownloadEngine engine;
+    engine.submit(url, filename, [&ok](const DownloadResult& result) { ok = result.ok; });
+    engine.close();
+    engine.run();
+    return ok;
+}
+
+void removeDownload(const std::string& filename) {
+    std::remove(filename.c_str());
+    std::remove((filename + ".part").c_str());
+    std::remove((filename + ".part.json").c_str());
+    std::remove((filename + ".part.json.tmp").c_str());
+}
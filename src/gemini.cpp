@@ -0,0 +1,259 @@
+/**
+ * @file	gemini.cpp
+ * @brief	Functions to interact with the Google Gemini API
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "gemini.h"
+
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+// Include the single-header JSON library (json.hpp downloaded locally)
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "dnscache.h"
+#include "log.h"
+#include "probes.h"
+#include "tlscache.h"
+
+namespace {
+
+/** @brief Guards transferStats */
+std::mutex statsMutex;
+
+/** @brief Bytes of the Google Gemini responses received so far */
+GeminiTransferStats transferStats;
+
+/**
+ * @brief SAX handler extracting the text of the candidates of a Google
+ *        Gemini response
+ * @details Instead of building the whole document, it only follows the
+ *          path candidates[*].content.parts[*].text, concatenating the
+ *          text of every part of each candidate. If only the first
+ *          candidate is wanted, the parser stops once it ends. Containers
+ *          off that path are skipped without keeping any state but their
+ *          nesting
+ */
+class TextExtractor : public nlohmann::json_sax<json> {
+public:
+    /**
+     * @brief Creates the handler
+     *
+     * @param firstOnly Whether only the first candidate is extracted
+     */
+    explicit TextExtractor(bool firstOnly) : firstOnly_(firstOnly) {}
+
+    /** @brief Whether the first candidate was read entirely (if only it is wanted) */
+    bool done() const { return done_; }
+
+    /** @brief Concatenated text of the parts of each candidate */
+    std::vector<std::string>& texts() { return texts_; }
+
+    /** @brief Error message, if the response is not valid JSON */
+    const std::string& error() const { return error_; }
+
+    bool null() override { return skip(); }
+    bool boolean(bool) override { return skip(); }
+    bool number_integer(number_integer_t) override { return skip(); }
+    bool number_unsigned(number_unsigned_t) override { return skip(); }
+    bool number_float(number_float_t, const string_t&) override { return skip(); }
+    bool binary(binary_t&) override { return skip(); }
+
+    bool string(string_t& val) override {
+        if (element() && frames_.size() == PATH_LENGTH) texts_.back() += val;
+        return true;
+    }
+
+    bool start_object(std::size_t) override { return start(false); }
+    bool start_array(std::size_t) override { return start(true); }
+    bool end_object() override { return end(); }
+    bool end_array() override { return end(); }
+
+    bool key(string_t& val) override {
+        Frame& frame = frames_.back();
+        frame.keyOnPath = frame.onPath && val == PATH[frames_.size() - 1];
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&,
+                     const nlohmann::detail::exception& ex) override {
+        error_ = ex.what();
+        return false;
+    }
+
+private:
+    /** @brief An object or array being parsed */
+    struct Frame {
+        bool array;             ///< Whether it is an array
+        bool onPath;            ///< Whether it lies on the path to the text
+        bool keyOnPath = false; ///< For objects, whether the current key is on the path
+        size_t index = 0;       ///< For arrays, index of the next element
+    };
+
+    /** @brief Path to the text: object keys and "*" for any element of an array */
+    static constexpr const char* PATH[] = {"candidates", "*", "content", "parts", "*", "text"};
+
+    /** @brief Depth of the object of a candidate */
+    static constexpr size_t CANDIDATE_DEPTH = 3;
+    static constexpr size_t PATH_LENGTH = sizeof(PATH) / sizeof(PATH[0]);
+
+    /**
+     * @brief Accounts a new element of the innermost container
+     *
+     * @return true if the element lies on the path to the text
+     */
+    bool element() {
+        if (frames_.empty()) return true;
+        Frame& frame = frames_.back();
+        size_t level = frames_.size() - 1;
+        if (frame.array) {
+            frame.index++;
+            return frame.onPath && level < PATH_LENGTH;
+        }
+        return frame.keyOnPath;
+    }
+
+    /**
+     * @brief Accounts a value that is never part of the text
+     *
+     * @return true to continue parsing
+     */
+    bool skip() {
+        element();
+        return true;
+    }
+
+    /**
+     * @brief Enters an object or array
+     *
+     * @param array Whether it is an array
+     * @return true to continue parsing
+     */
+    bool start(bool array) {
+        bool onPath = element() && frames_.size() < PATH_LENGTH;
+        frames_.push_back({array, onPath});
+        if (onPath && frames_.size() == CANDIDATE_DEPTH) texts_.emplace_back();
+        return true;
+    }
+
+    /**
+     * @brief Leaves an object or array
+     *
+     * @return false (stopping the parser) once the first candidate ends, if
+     *         only it is wanted
+     */
+    bool end() {
+        bool candidate = frames_.back().onPath && frames_.size() == CANDIDATE_DEPTH;
+        frames_.pop_back();
+        if (candidate && firstOnly_) done_ = true;
+        return !done_;
+    }
+
+    bool firstOnly_;                 ///< Whether only the first candidate is wanted
+    std::vector<Frame> frames_;      ///< Containers being parsed
+    std::vector<std::string> texts_; ///< Concatenated text of each candidate
+    std::string error_;              ///< Error message
+    bool done_ = false;              ///< Whether the first candidate was read
+};
+
+}  // namespace
+
+size_t writeCallback(void* contents, size_t size, size_t num_data, void* userp) {
+    ((std::string*)userp)->append((char*)contents, size * num_data);
+    return size * num_data;
+}
+
+std::string postToGemini(const std::string& apiKey, const std::string& prompt,
+                         int candidateCount) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return "";
+
+    std::string readBuffer;
+    std::string url =
+        GEMINI_API_URL + std::string(GENAI_MODEL) + ":generateContent?key=" +
+        apiKey;
+
+    // Google Gemini body request in JSON
+    json body = {
+        {"contents", {{{"role", "user"}, {"parts", {{{"text", prompt}}}}}}}};
+    if (candidateCount > 1) {
+        body["generationConfig"] = {{"candidateCount", candidateCount}};
+    }
+    std::string jsonData = body.dump();
+
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    DnsCache::instance().apply(curl, url);
+    // A POST is not idempotent, so it is never sent as TLS early data
+    TlsSessionCache::instance().apply(curl, false);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
+    // An empty string offers every encoding supported by this libcurl build
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+    PROBE_START(gemini, 0, jsonData.size());
+    CURLcode res = curl_easy_perform(curl);
+    PROBE_DONE(gemini, 0, readBuffer.size(), res == CURLE_OK);
+    curl_off_t received = 0;
+    curl_easy_getinfo(curl, CURLINFO_SIZE_DOWNLOAD_T, &received);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    {
+        std::lock_guard<std::mutex> lock(statsMutex);
+        transferStats.requests++;
+        transferStats.received += received;
+        transferStats.decoded += readBuffer.size();
+    }
+
+    if (res != CURLE_OK) {
+        LOG_ERROR("request failed: " << curl_easy_strerror(res));
+        return "";
+    }
+
+    return readBuffer;
+}
+
+std::string extractTextFromGemini(const std::string& response) {
+    TextExtractor extractor(true);
+    bool parsed = json::sax_parse(response, &extractor);
+    if (!parsed && !extractor.done()) {
+        LOG_ERROR("unable to parse response from Google Gemini: " << 
+            extractor.error());
+        return "";
+    }
+    std::vector<std::string>& texts = extractor.texts();
+    return texts.empty() ? "" : std::move(texts.front());
+}
+
+std::vector<std::string> extractTextsFromGemini(const std::string& response) {
+    TextExtractor extractor(false);
+    if (!json::sax_parse(response, &extractor)) {
+        LOG_ERROR("unable to parse response from Google Gemini: " << 
+            extractor.error());
+        return {};
+    }
+    return std::move(extractor.texts());
+}
+
+GeminiTransferStats geminiTransferStats() {
+    std::lock_guard<std::mutex> lock(statsMutex);
+    return transferStats;
+}
+
+void printGeminiTransferStats(const GeminiTransferStats& stats, std::ostream& out) {
+    double saved = stats.decoded > 0
+                       ? 100.0 * (stats.decoded - stats.received) / stats.decoded : 0;
+    out << "Google Gemini: " << stats.requests << " requests, " << stats.received / 1024
+        << " KB received for " << stats.decoded / 1024 << " KB of JSON (" << saved
+        << "% saved by compression)" << std::endl;
+}
@@ -4,26 +4,32 @@
  *          transformation to batches of images
  * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
  * @since	September 24, 2025
- * @date	September 28, 2025
+ * @date	October 18, 2026
  */
 
 #include <curl/curl.h>
-#include <sys/stat.h>
 
 #include <cstdlib>
 #include <fstream>
 #include <iostream>
-#include <opencv2/opencv.hpp>
-#include <sstream>
 #include <string>
 #include <vector>
 
-// Include the single-header JSON library (json.hpp downloaded locally)
-#include "json.hpp"
-using json = nlohmann::json;
-
-/** @brief Generative AI model */
-#define GENAI_MODEL "gemini-2.5-flash-lite"
+#include "advisor.h"
+#include "allocstats.h"
+#include "dnscache.h"
+#include "download.h"
+#include "gemini.h"
+#include "log.h"
+#include "openai.h"
+#include "pipeline.h"
+#include "profiler.h"
+#include "progress.h"
+#include "results.h"
+#include "slowlog.h"
+#include "storage.h"
+#include "tlscache.h"
+#include "urlsource.h"
 
 /** @brief Directory to store downloaded images */
 # define IMAGES_DIR "images/"
@@ -34,261 +40,249 @@ using json = nlohmann::json;
 /** @brief API key file for Google Gemini */
 # define APIKEY_FILE "googleai.key"
 
-/**
- * @brief A callback for libcurl.
- * @details When libcurl is used to to perform an HTTP request, it needs to
- *          know how to handle the incoming data (the response body).
- *          This function is registered with CURLOPT_WRITEFUNCTION, and each
- *          time libcurl receives a block of data, it calls this function.
- *
- * @param contents Pointer to the block of data received from the HTTP response
- * @param size The size (in bytes) of each data element
- * @param num_data The number of data elements
- * @param userp Pointer to a string that will hold the response
- * @return Number of bytes handled (size * num_data)
- */
-size_t writeCallback(void* contents, size_t size, size_t num_data, void* userp) {
-    ((std::string*)userp)->append((char*)contents, size * num_data);
-    return size * num_data;
-}
-
-/**
- * @brief Ensure that a directory exists, otherwise it creates the directory
- * 
- * @param dir Directory name
- */
-void makeDir(const std::string& dir) {
-    struct stat st;
-    if (stat(dir.c_str(), &st) == -1) {
-        mkdir(dir.c_str(), 0755);
-    }
-}
+/** @brief Command-line options */
+struct Options {
+    int numimages = 0;         ///< Number of images to process
+    int threads = 0;           ///< Threads processing images (the number of cores if 0)
+    std::string dnsCacheFile;  ///< File persisting resolved host names between runs
+    std::string tlsCacheFile;  ///< File persisting TLS sessions between runs
+    std::string openAiKeyFile;  ///< File holding the API key to an OpenAI-compatible endpoint
+    std::string source = URL_SOURCE_DEFAULT;    ///< Specification of the URL source
+    std::string images = IMAGES_DIR;            ///< Storage of the downloaded images
+    std::string output = GSIMAGES_DIR;          ///< Storage of the processed images
+    LogLevel logLevel = LogLevel::Info;         ///< Minimum level of the messages written
+    bool logJson = false;                       ///< Whether messages are written as JSON lines
+    bool progress = false;                      ///< Whether the progress is reported
+    std::string results;                        ///< File receiving the result of each image
+    std::string slowLog;                        ///< File receiving the slow images
+    double slowFactor = SLOW_LOG_FACTOR;        ///< Multiple of the p99 making a stage slow
+    std::string profile;                        ///< File receiving the profiled stacks
+    int profileHz = PROFILER_DEFAULT_HZ;        ///< Samples per second of the profiler
+    bool allocStats = false;                    ///< Whether allocations are accounted per task
+};
 
 /**
- * @brief Check if a URL is accessible by making an HTTP request to it
+ * @brief Parses the command-line arguments
+ * @details Usage: imageprocessing [--threads N] [--dns-cache FILE] [--tls-cache FILE]
+ *          [--source SPEC] [--openai-key-file FILE] [--images STORAGE] [--output STORAGE]
+ *          [--log-level LEVEL] [--log-json] [--progress] [--results FILE]
+ *          [--slow-log FILE] [--slow-factor FACTOR] [--profile FILE]
+ *          [--profile-hz HZ] [--alloc-stats] NUMIMAGES, where SPEC is
+ *          described in makeUrlSource(), STORAGE in makeStorage(), LEVEL in
+ *          parseLogLevel() and the results FILE may be - for the standard output
  *
- * @param url URL to check
- * @return true if the request is successful, false otherwise
+ * @param argc Number of command-line arguments
+ * @param argv Command-line arguments
+ * @param options Parsed options
+ * @return true if the arguments are valid, false otherwise
  */
-bool isAccessible(const std::string& url) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return false;
-
-    CURLcode res;
-    long response_code = 0;
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
-    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
-    res = curl_easy_perform(curl);
-    if (res == CURLE_OK) {
-        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = atoi(argv[++i]);
+            if (options.threads <= 0) {
+                LOG_ERROR("invalid number of threads " << argv[i]);
+                return false;
+            }
+        } else if (arg == "--dns-cache" && i + 1 < argc) {
+            options.dnsCacheFile = argv[++i];
+        } else if (arg == "--tls-cache" && i + 1 < argc) {
+            options.tlsCacheFile = argv[++i];
+        } else if (arg == "--source" && i + 1 < argc) {
+            options.source = argv[++i];
+        } else if (arg == "--openai-key-file" && i + 1 < argc) {
+            options.openAiKeyFile = argv[++i];
+        } else if (arg == "--images" && i + 1 < argc) {
+            options.images = argv[++i];
+        } else if (arg == "--output" && i + 1 < argc) {
+            options.output = argv[++i];
+        } else if (arg == "--log-level" && i + 1 < argc) {
+            if (!parseLogLevel(argv[++i], options.logLevel)) {
+                LOG_ERROR("unknown log level " << argv[i]);
+                return false;
+            }
+        } else if (arg == "--log-json") {
+            options.logJson = true;
+        } else if (arg == "--progress") {
+            options.progress = true;
+        } else if (arg == "--results" && i + 1 < argc) {
+            options.results = argv[++i];
+        } else if (arg == "--slow-log" && i + 1 < argc) {
+            options.slowLog = argv[++i];
+        } else if (arg == "--slow-factor" && i + 1 < argc) {
+            options.slowFactor = atof(argv[++i]);
+            if (options.slowFactor <= 0) {
+                LOG_ERROR("invalid slow factor " << argv[i]);
+                return false;
+            }
+        } else if (arg == "--profile" && i + 1 < argc) {
+            options.profile = argv[++i];
+        } else if (arg == "--profile-hz" && i + 1 < argc) {
+            options.profileHz = atoi(argv[++i]);
+            if (options.profileHz <= 0) {
+                LOG_ERROR("invalid profiler rate " << argv[i]);
+                return false;
+            }
+        } else if (arg == "--alloc-stats") {
+            options.allocStats = true;
+        } else if (arg.compare(0, 2, "--") == 0) {
+            LOG_ERROR("unknown option " << arg);
+            return false;
+        } else {
+            options.numimages = atoi(argv[i]);
+        }
     }
-    curl_easy_cleanup(curl);
-
-    return (res == CURLE_OK && response_code == 200);
+    if (options.numimages <= 0) {
+        LOG_ERROR("the number of images to process is missing.");
+        return false;
+    }
+    return true;
 }
 
 /**
- * @brief Downloads an image from its URL
+ * @brief Reads an API key from the first line of a file
  *
- * @param url URL to the image
- * @param filename Name of the file for the downloaded image
+ * @param filename Key file
+ * @param key Key read
+ * @return true if the file was read, false otherwise
  */
-void downloadImage(const std::string& url, const std::string& filename) {
-    CURL* curl = curl_easy_init();
-    if (!curl) exit(1);
-
-    FILE* fp = fopen(filename.c_str(), "wb");
-    if (!fp) exit(1);
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, nullptr);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, fp);
-    curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-
-    CURLcode res = curl_easy_perform(curl);
-    fclose(fp);
-    curl_easy_cleanup(curl);
-    if (res != CURLE_OK) return;
+bool readKey(const std::string& filename, std::string& key) {
+    std::ifstream keyFile(filename);
+    if (!keyFile) return false;
+    std::getline(keyFile, key);
+    return true;
 }
 
 /**
- * @brief Applies grayscale transformation to an image using facilities from
- * OpenCV
- *
- * @param input_file Image file to process
- * @param output_file Resulting processed image file
+ * @brief Keeps libcurl initialized while in scope
+ * @details It must be declared before anything holding libcurl handles
+ *          (storages, URL sources, pipelines), so that, on every exit, they
+ *          are destroyed first; the process-wide handles (S3 inputs and TLS
+ *          sessions) are then released before libcurl itself
  */
-void toGrayscale(const std::string& input_file, const std::string& output_file) {
-    cv::Mat image = cv::imread(input_file);
-    if (image.empty()) {
-        std::cerr << "Error: unable to read " << input_file << " file" << std::endl;
-        return;
+class CurlGlobalGuard {
+public:
+    CurlGlobalGuard() { curl_global_init(CURL_GLOBAL_DEFAULT); }
+
+    ~CurlGlobalGuard() {
+        releaseS3Storages();
+        TlsSessionCache::instance().release();
+        curl_global_cleanup();
     }
-    cv::Mat gray;
-    cv::cvtColor(image, gray, cv::COLOR_BGR2GRAY);
-    cv::imwrite(output_file, gray);
-}
 
-/**
- * @brief Make an HTTP POST request to the Google Gemini API
- * 
- * @param apiKey API key to interact with the API
- * @param prompt Prompt to be executed on Google Gemini
- * @return Output provided by Google Gemini 
- */
-std::string postToGemini(const std::string& apiKey, const std::string& prompt) {
-    CURL* curl = curl_easy_init();
-    if (!curl) return "";
-
-    std::string readBuffer;
-    std::string url =
-        "https://generativelanguage.googleapis.com/v1beta/models/" +
-        std::string(GENAI_MODEL) + ":generateContent?key=" +
-        apiKey;
-
-    // Google Gemini body request in JSON
-    json body = {
-        {"contents", {{{"role", "user"}, {"parts", {{{"text", prompt}}}}}}}};
-    std::string jsonData = body.dump();
-
-    struct curl_slist* headers = nullptr;
-    headers = curl_slist_append(headers, "Content-Type: application/json");
-
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
-    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
-
-    CURLcode res = curl_easy_perform(curl);
-    curl_slist_free_all(headers);
-    curl_easy_cleanup(curl);
-
-    if (res != CURLE_OK) {
-        std::cerr << "Error in request: " << curl_easy_strerror(res) << std::endl;
-        return "";
-    }
-
-    return readBuffer;
-}
+    CurlGlobalGuard(const CurlGlobalGuard&) = delete;
+    CurlGlobalGuard& operator=(const CurlGlobalGuard&) = delete;
+};
 
 /**
- * @brief Extract text from Google Gemini response
+ * @brief Main function
  * 
- * @param response Response in JSON format
- * @return Extracted text
+ * @param argc Number of command-line arguments
+ * @param argv Command-line arguments
+ * @return Execution status
  */
-std::string extractTextFromGemini(const std::string& response) {
-    try {
-        json j = json::parse(response);
-        if (j.contains("candidates") && !j["candidates"].empty()) {
-            return j["candidates"][0]["content"]["parts"][0]["text"];
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) return 1;
+    Logger::instance().setLevel(options.logLevel);
+    Logger::instance().setJson(options.logJson);
+    if (!options.profile.empty()) Profiler::instance().start(options.profileHz);
+    if (options.allocStats) startAllocationStats();
+
+    // Each model gets its own key, so that the key to Google Gemini never
+    // reaches another endpoint
+    bool gemini = options.source == "gemini";
+    bool openAi = options.source.compare(0, options.source.find('='), "openai") == 0;
+    std::string geminiKey, openAiKey;
+    if (gemini && !readKey(APIKEY_FILE, geminiKey)) {
+        LOG_ERROR("API key file is missing");
+        return 1;
+    }
+    if (openAi && !options.openAiKeyFile.empty()) {
+        if (!readKey(options.openAiKeyFile, openAiKey)) {
+            LOG_ERROR("unable to read " << options.openAiKeyFile << " file");
+            return 1;
         }
-    } catch (std::exception& e) {
-        std::cerr << "Error when parsing response from Google Gemini: " << 
-            e.what() << std::endl;
+    } else if (openAi && getenv(OPENAI_KEY_VAR)) {
+        openAiKey = getenv(OPENAI_KEY_VAR);
     }
-    return "";
-}
 
-// Generate image URLs (two-step: generate -> extract)
-/**
- * @brief Generates a list of public domain image URL from public domain image
- *        repositories on the Web
- * @details Google Gemini is utilized to generate the list of image URLs in a
- *          two-step process with two prompts. The first one generates URLs
- *          directly pointing to a valid image file in either JPEG or PNG format. The
- *          second one is used to extract only the list of URLs from the output of the
- *          first prompt as there is no guarantee that the first prompt generates only the
- *          list of image URLs
- *
- * @param apiKey API key to Google Gemini
- * @param numimages Number of images to generate
- * @return List of image URLs
- */
-std::vector<std::string> generateImageUrls(const std::string& apiKey, int numimages) {
-    std::vector<std::string> image_urls;
-    while (image_urls.size() < (size_t)numimages) {
-        std::ostringstream generationPrompt;
-        generationPrompt << "Generate " << numimages
-                         << " public domain image URLs (either JPEG or PNG format)" 
-                         << " from trusted public domain image repositories. Exclude"
-                         << " Wikimedia Commons and related sites. The URL must directly"
-                         << " point to a valid image file ending with.jpg or .png, and"
-                         << " the file size must be less than 200 KB. Provide the final"
-                         << " image URLs in plain text.";
-        std::string generationResponse =
-            postToGemini(apiKey, generationPrompt.str());
-        std::string genText = extractTextFromGemini(generationResponse);
+    // Initialize libcurl before any thread uses it
+    CurlGlobalGuard curl;
 
-        std::ostringstream extractionPrompt;
-        extractionPrompt
-            << "Extract all URLs from the following contents into a plain text "
-               "list. Each URL must be on a new line. These are the contents: "
-            << genText;
-        std::string extractionResponse =
-            postToGemini(apiKey, extractionPrompt.str());
-        std::string urlsText = extractTextFromGemini(extractionResponse);
+    // Warm up the resolver cache with the hosts of the last run and the API
+    DnsCache& dnsCache = DnsCache::instance();
+    if (!options.dnsCacheFile.empty()) dnsCache.load(options.dnsCacheFile);
+    if (gemini) dnsCache.prefetch({GEMINI_API_URL});
 
-        // Split lines and validate URLs
-        std::vector<std::string> candidate_urls;
-        std::istringstream iss(urlsText);
-        std::string line;
-        while (std::getline(iss, line)) {
-            if (line.find("http") != std::string::npos) {
-                candidate_urls.push_back(line);
-            }
-        }
+    // Resume the TLS sessions of the last run instead of full handshakes
+    TlsSessionCache& tlsCache = TlsSessionCache::instance();
+    if (!options.tlsCacheFile.empty()) tlsCache.load(options.tlsCacheFile);
 
-        // Check if URLs are accessible
-        for (const auto& url : candidate_urls) {
-            if (isAccessible(url)) {
-                image_urls.push_back(url);
-                if (image_urls.size() == (size_t)numimages) break;
-            }
-        }
+    std::unique_ptr<Storage> images = makeStorage(options.images);
+    std::unique_ptr<Storage> output = makeStorage(options.output);
+
+    // Results written to the standard output push the reports to the standard error
+    std::unique_ptr<ResultStream> results;
+    if (!options.results.empty()) results = std::make_unique<ResultStream>(options.results);
+    std::ostream& report = options.results == "-" ? std::cerr : std::cout;
+    std::unique_ptr<SlowLog> slowLog;
+    if (!options.slowLog.empty()) {
+        slowLog = std::make_unique<SlowLog>(options.slowLog, options.slowFactor);
     }
-    
-    return image_urls;
-}
 
-/**
- * @brief Main function
- * 
- * @param argc Number of command-line arguments
- * @param argv Command-line arguments
- * @return Execution status
- */
-int main(int argc, char* argv[]) {
-    std::ifstream keyFile(APIKEY_FILE);
-    if (!keyFile) {
-        std::cerr << "API key file is missing" << std::endl;
+    std::unique_ptr<UrlSource> source = makeUrlSource(options.source, geminiKey, openAiKey);
+    if (!source || !images || !output || (results && !results->valid()) ||
+        (slowLog && !slowLog->valid())) {
         return 1;
     }
-    std::string apiKey;
-    std::getline(keyFile, apiKey);
-
-    // Create images directories
-    makeDir(IMAGES_DIR);
-    makeDir(GSIMAGES_DIR);
 
-    if (argc == 2) {
-        int numimages = atoi(argv[1]);
-        std::vector<std::string> imageUrls = generateImageUrls(apiKey, numimages);
-
-        // For each image URL, downloads the image and converts to grayscale
-        for (size_t i = 0; i < imageUrls.size(); i++) {
-            std::string filename = IMAGES_DIR + std::to_string(i + 1) + ".jpg";
-            std::string grayFile = GSIMAGES_DIR + std::to_string(i + 1) + ".jpg";
-            downloadImage(imageUrls[i], filename);
-            toGrayscale(filename, grayFile);
+    // Downloads images as soon as their URLs are pulled, while the next batch
+    // of URLs is prefetched, and converts each one to grayscale on a pool of
+    // threads as soon as it is downloaded. Images already in an S3 bucket are
+    // read from there instead, and files on disk (downloads and local inputs)
+    // are decoded straight from a memory mapping
+    size_t numimages = options.numimages;
+    Progress progress(numimages);
+    Pipeline::Builder builder;
+    builder.source(std::move(source))
+        .originals(std::move(images))
+        .output(std::move(output))
+        .progress(&progress);
+    if (options.threads > 0) builder.threads(options.threads);
+    std::unique_ptr<Pipeline> pipeline = builder.build();
+    if (!pipeline) return 1;
+    // Stages are sampled anyway, for the bottleneck analysis
+    progress.start(options.progress);
+    // Each image ends in the result stream and, if it was slow, in the slow
+    // log as soon as it is processed, on the thread that processed it
+    pipeline->run(numimages, [&](ProcessedImage&& image) {
+        ImageResult& result = image.result;
+        if (!result.ok) LOG_ERROR(result.error << " " << result.url);
+        if (results) {
+            if (!image.data.empty()) result.sha256 = sha256(image.data.data(), image.data.size());
+            results->write(result);
+        }
+        if (slowLog) {
+            slowLog->observe(result, image.download.url.empty() ? nullptr : &image.download,
+                             image.format);
         }
+    });
+    progress.stop();
+    printHostMetrics(pipeline->hostMetrics(), report);
+    printBottleneckAnalysis(progress.loads(), progress.sampledSeconds(), report);
 
-        return 0;
-    } else {
-        std::cerr << "Error: the number of images to process is missing." << std::endl;
-        return 1;
+    if (gemini) printGeminiTransferStats(geminiTransferStats(), report);
+    if (options.allocStats) printAllocationStats(allocationStats(), report);
+
+    if (!options.profile.empty()) {
+        Profiler::instance().stop();
+        Profiler::instance().write(options.profile);
     }
-}
\ No newline at end of file
+
+    if (!options.dnsCacheFile.empty()) dnsCache.save(options.dnsCacheFile);
+    if (!options.tlsCacheFile.empty()) tlsCache.save(options.tlsCacheFile);
+    // The pipeline (holding libcurl handles) is destroyed before the guard of libcurl
+    return 0;
+}
@@ -0,0 +1,245 @@
+/**
+ * @file	log.cpp
+ * @brief	Asynchronous logger with per-thread buffers
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "log.h"
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+
+// Include the single-header JSON library (json.hpp downloaded locally)
+#include "json.hpp"
+using json = nlohmann::json;
+
+namespace {
+
+/** @brief Names of the levels, as accepted by parseLogLevel() */
+const char* const LEVEL_NAMES[] = {"debug", "info", "warning", "error"};
+
+/** @brief Prefixes of the levels in text messages */
+const char* const LEVEL_PREFIXES[] = {"Debug: ", "", "Warning: ", "Error: "};
+
+}  // namespace
+
+bool parseLogLevel(const std::string& name, LogLevel& level) {
+    for (int i = 0; i < 4; i++) {
+        if (name == LEVEL_NAMES[i]) {
+            level = (LogLevel)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+Logger::Logger() : terminal_(isatty(STDERR_FILENO)), flusher_([this] { run(); }) {}
+
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stop_ = true;
+    }
+    stopped_.notify_one();
+    flusher_.join();
+}
+
+/** @brief Retrieves the ring of the current thread, creating it on first use */
+Logger::Ring& Logger::ring() {
+    // Marks the ring as closed when the thread exits, so that the flusher
+    // releases it once drained
+    thread_local struct Local {
+        Ring* ring = nullptr;
+        ~Local() {
+            if (ring) ring->closed.store(true, std::memory_order_release);
+        }
+    } local;
+
+    if (!local.ring) {
+        auto ring = std::make_unique<Ring>();
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        ring->thread = ++threads_;
+        local.ring = ring.get();
+        rings_.push_back(std::move(ring));
+    }
+    return *local.ring;
+}
+
+void Logger::log(LogLevel level, const char* site, std::string message) {
+    Ring& ring = this->ring();
+    size_t tail = ring.tail.load(std::memory_order_relaxed);
+    if (tail - ring.head.load(std::memory_order_acquire) >= LOG_RING_CAPACITY) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+    Record& record = ring.slots[tail % LOG_RING_CAPACITY];
+    record.time = Clock::now();
+    record.level = level;
+    record.site = site;
+    record.thread = ring.thread;
+    record.message = std::move(message);
+    ring.tail.store(tail + 1, std::memory_order_release);
+}
+
+void Logger::setStatus(std::string line) {
+    std::lock_guard<std::mutex> lock(statusMutex_);
+    status_ = std::move(line);
+}
+
+void Logger::flush() {
+    drain(true);
+}
+
+/** @brief Drains the rings every LOG_FLUSH_INTERVAL_MS until the logger is destroyed */
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stop_) {
+        stopped_.wait_for(lock, std::chrono::milliseconds(LOG_FLUSH_INTERVAL_MS),
+                          [this] { return stop_; });
+        lock.unlock();
+        drain(false);
+        lock.lock();
+    }
+    lock.unlock();
+    drain(true);
+}
+
+/**
+ * @brief Writes the messages buffered by all threads, in time order
+ *
+ * @param all Whether the messages suppressed in windows that did not end
+ *        yet are also reported
+ */
+void Logger::drain(bool all) {
+    std::lock_guard<std::mutex> drainLock(drainMutex_);
+    std::vector<Record> records;
+    size_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex_);
+        for (auto it = rings_.begin(); it != rings_.end();) {
+            Ring& ring = **it;
+            // Read before draining, so that no message is left in a closed ring
+            bool closed = ring.closed.load(std::memory_order_acquire);
+            size_t head = ring.head.load(std::memory_order_relaxed);
+            size_t tail = ring.tail.load(std::memory_order_acquire);
+            for (; head != tail; head++) {
+                records.push_back(std::move(ring.slots[head % LOG_RING_CAPACITY]));
+            }
+            ring.head.store(head, std::memory_order_release);
+            dropped += ring.dropped.exchange(0, std::memory_order_relaxed);
+            it = closed ? rings_.erase(it) : it + 1;
+        }
+    }
+    std::stable_sort(records.begin(), records.end(),
+                     [](const Record& a, const Record& b) { return a.time < b.time; });
+
+    std::string out;
+    const auto window = std::chrono::milliseconds(LOG_REPEAT_WINDOW_MS);
+    auto suppressed = [&out, this](Repeat& repeat) {
+        Record summary;
+        summary.time = Clock::now();
+        summary.level = repeat.level;
+        summary.site = repeat.site;
+        summary.message = repeat.message + " (repeated " + std::to_string(repeat.suppressed) +
+                          " more times)";
+        write(summary, out);
+        repeat.suppressed = 0;
+    };
+    // Only copies of the same message are suppressed, so that a statement
+    // reporting many distinct failures (e.g., of each image) reports them all
+    for (const auto& record : records) {
+        Repeat& repeat = repeats_[std::string(record.site) + '\n' + record.message];
+        if (repeat.count == 0) {
+            repeat.site = record.site;
+            repeat.message = record.message;
+        }
+        if (record.time - repeat.windowStart >= window) {
+            if (repeat.suppressed > 0) suppressed(repeat);
+            repeat.windowStart = record.time;
+            repeat.count = 0;
+        }
+        if (++repeat.count > LOG_REPEAT_LIMIT) {
+            repeat.suppressed++;
+            repeat.level = record.level;
+            continue;
+        }
+        write(record, out);
+    }
+    Clock::time_point now = Clock::now();
+    for (auto it = repeats_.begin(); it != repeats_.end();) {
+        Repeat& repeat = it->second;
+        bool expired = now - repeat.windowStart >= window;
+        if (repeat.suppressed > 0 && (all || expired)) suppressed(repeat);
+        // Messages not seen within the window are forgotten
+        it = expired && repeat.suppressed == 0 ? repeats_.erase(it) : std::next(it);
+    }
+    if (dropped > 0) {
+        Record summary;
+        summary.time = now;
+        summary.level = LogLevel::Warning;
+        summary.site = __FILE__;
+        summary.message = std::to_string(dropped) + " messages dropped (buffers full)";
+        write(summary, out);
+    }
+
+    // Messages are written over the status line, which is then redrawn
+    if (interactive()) {
+        std::string status;
+        {
+            std::lock_guard<std::mutex> lock(statusMutex_);
+            status = status_;
+        }
+        if (!out.empty() || status != shown_) {
+            if (!shown_.empty()) out.insert(0, "\r\033[K");
+            out += status;
+            shown_ = std::move(status);
+        }
+    }
+
+    if (!out.empty()) {
+        fwrite(out.data(), 1, out.size(), stderr);
+        fflush(stderr);
+    }
+}
+
+/**
+ * @brief Formats a message
+ *
+ * @param record Message
+ * @param out Buffer receiving the formatted message
+ */
+void Logger::write(const Record& record, std::string& out) {
+    if (!json_.load(std::memory_order_relaxed)) {
+        out += LEVEL_PREFIXES[(int)record.level];
+        out += record.message;
+        out += '\n';
+        return;
+    }
+
+    auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(
+                      record.time.time_since_epoch()).count();
+    time_t seconds = (time_t)(millis / 1000);
+    struct tm utc;
+    gmtime_r(&seconds, &utc);
+    char time[32];
+    size_t length = strftime(time, sizeof(time), "%Y-%m-%dT%H:%M:%S", &utc);
+    snprintf(time + length, sizeof(time) - length, ".%03dZ", (int)(millis % 1000));
+
+    json line = {{"time", time},
+                 {"level", LEVEL_NAMES[(int)record.level]},
+                 {"thread", record.thread},
+                 {"site", record.site},
+                 {"message", record.message}};
+    out += line.dump(-1, ' ', false, json::error_handler_t::replace);
+    out += '\n';
+}
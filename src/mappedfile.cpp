@@ -0,0 +1,57 @@
+/**
+ * @file	mappedfile.cpp
+ * @brief	Read-only memory mapping of local files
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "mappedfile.h"
+
+#include <curl/curl.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return;
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t size = (size_t)st.st_size;
+        int flags = MAP_PRIVATE;
+        if (size <= (size_t)MAPPED_FILE_POPULATE_LIMIT) flags |= MAP_POPULATE;
+        void* data = mmap(nullptr, size, PROT_READ, flags, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, size, MADV_SEQUENTIAL);
+            data_ = (unsigned char*)data;
+            size_ = size;
+        }
+    }
+    // The mapping keeps the file alive
+    close(fd);
+}
+
+MappedFile::~MappedFile() {
+    if (data_) munmap(data_, size_);
+}
+
+std::string localPathOf(const std::string& url) {
+    if (url.compare(0, 7, "file://") != 0) {
+        // Only explicit paths, so that a mistyped URL is never taken for a file
+        bool explicitPath = url.compare(0, 1, "/") == 0 || url.compare(0, 2, "./") == 0 ||
+                            url.compare(0, 3, "../") == 0;
+        return explicitPath ? url : "";
+    }
+    std::string path;
+    CURLU* handle = curl_url();
+    char* part = nullptr;
+    if (handle && curl_url_set(handle, CURLUPART_URL, url.c_str(), 0) == CURLUE_OK &&
+        curl_url_get(handle, CURLUPART_PATH, &part, CURLU_URLDECODE) == CURLUE_OK) {
+        path = part;
+        curl_free(part);
+    }
+    curl_url_cleanup(handle);
+    return path;
+}
@@ -0,0 +1,80 @@
+/**
+ * @file	openai.cpp
+ * @brief	Functions to interact with OpenAI-compatible chat completion APIs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "openai.h"
+
+#include <curl/curl.h>
+
+
+// Include the single-header JSON library (json.hpp downloaded locally)
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "dnscache.h"
+#include "gemini.h"
+#include "log.h"
+#include "probes.h"
+#include "tlscache.h"
+
+std::string postToOpenAi(const std::string& baseUrl, const std::string& model,
+                         const std::string& apiKey, const std::string& prompt,
+                         int choiceCount) {
+    CURL* curl = curl_easy_init();
+    if (!curl) return "";
+
+    std::string readBuffer;
+    std::string url = baseUrl + "/chat/completions";
+
+    json body = {
+        {"model", model},
+        {"messages", {{{"role", "user"}, {"content", prompt}}}}};
+    if (choiceCount > 1) body["n"] = choiceCount;
+    std::string jsonData = body.dump();
+
+    struct curl_slist* headers = nullptr;
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    if (!apiKey.empty()) {
+        headers = curl_slist_append(headers, ("Authorization: Bearer " + apiKey).c_str());
+    }
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    DnsCache::instance().apply(curl, url);
+    TlsSessionCache::instance().apply(curl, false);
+    curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
+    curl_easy_setopt(curl, CURLOPT_POSTFIELDS, jsonData.c_str());
+    curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, writeCallback);
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &readBuffer);
+
+    PROBE_START(openai, 0, jsonData.size());
+    CURLcode res = curl_easy_perform(curl);
+    PROBE_DONE(openai, 0, readBuffer.size(), res == CURLE_OK);
+    curl_slist_free_all(headers);
+    curl_easy_cleanup(curl);
+
+    if (res != CURLE_OK) {
+        LOG_ERROR("request failed: " << curl_easy_strerror(res));
+        return "";
+    }
+
+    return readBuffer;
+}
+
+std::vector<std::string> extractTextsFromOpenAi(const std::string& response) {
+    std::vector<std::string> texts;
+    try {
+        json parsed = json::parse(response);
+        for (const auto& choice : parsed.at("choices")) {
+            texts.push_back(choice.at("message").at("content").get<std::string>());
+        }
+    } catch (const json::exception& e) {
+        LOG_ERROR("unable to parse response from the chat completion API: " << 
+            e.what());
+    }
+    return texts;
+}
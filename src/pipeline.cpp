@@ -0,0 +1,595 @@
+/**
+ * @file	pipeline.cpp
+ * @brief	In-process pipeline downloading and transforming batches of images
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "pipeline.h"
+
+#include <curl/curl.h>
+#include <dirent.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+#include "log.h"
+#include "mappedfile.h"
+#include "probes.h"
+#include "progress.h"
+#include "slowlog.h"
+#include "task.h"
+#include "tlscache.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Computes the time elapsed since an instant
+ *
+ * @param start Instant
+ * @return Time (in seconds) elapsed
+ */
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/**
+ * @brief Creates a private staging directory for the downloads
+ * @details The directory is created by mkdtemp(), so only its owner can
+ *          enter it and no other user can plant files (e.g., symbolic
+ *          links) where the downloads land
+ *
+ * @return Path to a new imageprocessing-XXXXXX subdirectory of the
+ *         temporary directory, or an empty string if it could not be created
+ */
+std::string makeDownloadsDir() {
+    const char* tmp = getenv("TMPDIR");
+    std::string dir = std::string(tmp && *tmp ? tmp : "/tmp") + "/imageprocessing-XXXXXX";
+    if (!mkdtemp(&dir[0])) {
+        LOG_ERROR("unable to create a staging directory in " << (tmp && *tmp ? tmp : "/tmp"));
+        return "";
+    }
+    return dir;
+}
+
+/**
+ * @brief Removes a directory and the files in it
+ *
+ * @param dir Directory
+ */
+void removeDir(const std::string& dir) {
+    if (DIR* handle = opendir(dir.c_str())) {
+        while (struct dirent* entry = readdir(handle)) {
+            std::string name = entry->d_name;
+            if (name != "." && name != "..") unlink((dir + "/" + name).c_str());
+        }
+        closedir(handle);
+    }
+    rmdir(dir.c_str());
+}
+
+/**
+ * @brief Item of a stage, timed and reported to the progress of the
+ *        pipeline if it has one
+ */
+class StageScope {
+public:
+    /**
+     * @brief Starts an item of a stage
+     *
+     * @param progress Progress counting the item, or nullptr
+     * @param stage Stage of the item
+     */
+    StageScope(Progress* progress, Stage stage) {
+        if (progress) scope_.emplace(*progress, stage);
+    }
+
+    /** @brief Sets the number of items actually processed (1 by default) */
+    void setItems(size_t items) {
+        if (scope_) scope_->setItems(items);
+    }
+
+    /** @brief Sets the bytes processed */
+    void setBytes(uint64_t bytes) {
+        if (scope_) scope_->setBytes(bytes);
+    }
+
+    /** @brief Marks the item as failed */
+    void fail() {
+        if (scope_) scope_->fail();
+    }
+
+    /** @brief Time (in seconds) elapsed since the item started */
+    double seconds() const { return secondsSince(start_); }
+
+private:
+    Clock::time_point start_ = Clock::now();
+    std::optional<Progress::Scope> scope_;
+};
+
+/** @brief Guards live */
+std::mutex liveMutex;
+
+/** @brief Pipelines alive in the process */
+size_t live = 0;
+
+}  // namespace
+
+/** @brief Image of a batch ready to be processed */
+struct Pipeline::Job {
+    size_t index = 0;          ///< Position of the image in its batch
+    std::string url;           ///< URL (or local path) of the image
+    DownloadResult download;   ///< Outcome of its download, if downloaded
+};
+
+Transform grayscale() {
+    return [](const cv::Mat& input, cv::Mat& output) {
+        if (input.channels() == 1) {
+            input.copyTo(output);
+        } else {
+            cv::cvtColor(input, output,
+                         input.channels() == 4 ? cv::COLOR_BGRA2GRAY : cv::COLOR_BGR2GRAY);
+        }
+        return !output.empty();
+    };
+}
+
+Pipeline::Builder::Builder() : pipeline_(new Pipeline()) {}
+
+Pipeline::Builder& Pipeline::Builder::source(std::unique_ptr<UrlSource> source) {
+    pipeline_->source_ = std::move(source);
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::transform(Transform transform) {
+    pipeline_->transforms_.push_back(std::move(transform));
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::format(const std::string& extension) {
+    pipeline_->format_ = extension;
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::output(std::unique_ptr<Storage> storage) {
+    pipeline_->output_ = std::move(storage);
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::originals(std::unique_ptr<Storage> storage) {
+    pipeline_->originals_ = std::move(storage);
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::downloads(const std::string& dir, bool keep) {
+    downloads_ = dir;
+    pipeline_->keepDownloads_ = keep;
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::downloadOptions(const DownloadEngine::Options& options) {
+    pipeline_->downloadOptions_ = options;
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::threads(size_t threads) {
+    pipeline_->threads_ = std::max<size_t>(threads, 1);
+    return *this;
+}
+
+Pipeline::Builder& Pipeline::Builder::progress(Progress* progress) {
+    pipeline_->progress_ = progress;
+    return *this;
+}
+
+std::unique_ptr<Pipeline> Pipeline::Builder::build() {
+    Pipeline* pipeline = pipeline_.get();
+    if (!cv::haveImageWriter(pipeline->format_)) {
+        LOG_ERROR("no encoder for the " << pipeline->format_ << " format");
+        return nullptr;
+    }
+    if (pipeline->transforms_.empty()) pipeline->transforms_.push_back(grayscale());
+    // Only downloads kept in a remote storage need to be staged
+    if (!pipeline->originals_ || pipeline->originals_->localPath("").empty()) {
+        std::string dir = downloads_;
+        if (dir.empty()) {
+            dir = pipeline->stagingDir_ = makeDownloadsDir();
+            if (dir.empty()) return nullptr;
+        }
+        pipeline->downloads_ = std::make_unique<LocalStorage>(dir);
+    }
+    if (Progress* progress = pipeline->progress_) {
+        // Each thread reads, converts and uploads an image after the other
+        progress->setWorkers(Stage::Read, pipeline->threads_);
+        progress->shareWorkers(Stage::Read, Stage::Upload);
+        progress->setPool(
+            Stage::Download, [pipeline] { return pipeline->engineGauge(&DownloadEngine::inFlight); },
+            [pipeline] { return pipeline->engineGauge(&DownloadEngine::window); });
+    }
+    return std::move(pipeline_);
+}
+
+Pipeline::Pipeline() : threads_(std::max(1u, std::thread::hardware_concurrency())) {
+    // Reference-counted, so it can be shared with the caller and other pipelines
+    std::lock_guard<std::mutex> lock(liveMutex);
+    live++;
+    curl_global_init(CURL_GLOBAL_DEFAULT);
+}
+
+Pipeline::~Pipeline() {
+    // Storages and sources hold libcurl handles, released before libcurl itself
+    output_.reset();
+    originals_.reset();
+    source_.reset();
+    std::lock_guard<std::mutex> lock(liveMutex);
+    // So do the process-wide storages of S3 inputs and the TLS sessions,
+    // which the last pipeline releases
+    if (--live == 0) {
+        releaseS3Storages();
+        TlsSessionCache::instance().release();
+    }
+    curl_global_cleanup();
+    if (!stagingDir_.empty() && !keepDownloads_) removeDir(stagingDir_);
+}
+
+void Pipeline::process(const std::vector<std::string>& urls, Callback callback) {
+    bool fed = false;
+    execute(
+        [&urls, &fed] {
+            if (fed) return std::vector<std::string>();
+            fed = true;
+            return urls;
+        },
+        callback);
+}
+
+std::future<std::vector<ProcessedImage>> Pipeline::submit(std::vector<std::string> urls) {
+    return std::async(std::launch::async, [this, urls = std::move(urls)] {
+        std::vector<ProcessedImage> images(urls.size());
+        // Each image is moved into its own position, whatever the thread
+        process(urls, [&images](ProcessedImage&& image) {
+            images[image.index] = std::move(image);
+        });
+        return images;
+    });
+}
+
+size_t Pipeline::run(size_t count, Callback callback) {
+    size_t pulled = 0;
+    execute(
+        [this, count, &pulled] {
+            if (!source_ || pulled >= count) return std::vector<std::string>();
+            std::vector<std::string> urls;
+            {
+                StageScope scope(progress_, Stage::Source);
+                urls = source_->pull(std::min<size_t>(URL_SOURCE_BATCH, count - pulled));
+                scope.setItems(urls.size());
+            }
+            if (urls.empty()) {
+                LOG_ERROR(source_->name() << " ran out of URLs after " << pulled << " images");
+                return urls;
+            }
+            pulled += urls.size();
+            if (pulled < count) {
+                source_->prefetch(std::min<size_t>(URL_SOURCE_BATCH, count - pulled));
+            }
+            return urls;
+        },
+        callback);
+    return pulled;
+}
+
+ProcessedImage Pipeline::convert(const unsigned char* data, size_t size, uint64_t id) const {
+    ProcessedImage image;
+    ImageResult& result = image.result;
+    result.inputBytes = size;
+    auto start = Clock::now();
+    result.ok = encode(data, size, image, id);
+    result.seconds[(int)Stage::Convert] = secondsSince(start);
+    return image;
+}
+
+bool Pipeline::apply(const cv::Mat& input, cv::Mat& output) const {
+    if (transforms_.empty()) {
+        output = input;
+        return true;
+    }
+    // Intermediate images alternate between two matrices, reusing their buffers
+    cv::Mat intermediate[2];
+    const cv::Mat* current = &input;
+    for (size_t i = 0; i < transforms_.size(); i++) {
+        cv::Mat& next = i + 1 == transforms_.size() ? output : intermediate[i % 2];
+        if (!transforms_[i](*current, next)) return false;
+        current = &next;
+    }
+    return true;
+}
+
+std::vector<HostMetrics> Pipeline::hostMetrics() const {
+    std::lock_guard<std::mutex> lock(enginesMutex_);
+    return hostMetrics_;
+}
+
+/**
+ * @brief Processes a batch, downloading its images and handing them to a
+ *        pool of threads as soon as they are ready
+ *
+ * @param feed Function returning the next URLs of the batch
+ * @param callback Function receiving each processed image
+ */
+void Pipeline::execute(const Feed& feed, const Callback& callback) {
+    // Downloads of concurrent batches (and processes) must not share files
+    std::string prefix = std::to_string(getpid()) + "-" + std::to_string(++batches_) + "-";
+
+    std::mutex mutex;
+    std::condition_variable ready;
+    std::deque<Job> jobs;
+    bool closed = false;
+    auto push = [&mutex, &ready, &jobs](Job&& job) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            jobs.push_back(std::move(job));
+        }
+        ready.notify_one();
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads_; i++) {
+        workers.emplace_back([&] {
+            while (true) {
+                Job job;
+                {
+                    std::unique_lock<std::mutex> lock(mutex);
+                    ready.wait(lock, [&] { return closed || !jobs.empty(); });
+                    if (jobs.empty()) return;
+                    job = std::move(jobs.front());
+                    jobs.pop_front();
+                }
+                callback(processJob(job, prefix));
+            }
+        });
+    }
+
+    DownloadEngine engine(downloadOptions_);
+    {
+        std::lock_guard<std::mutex> lock(enginesMutex_);
+        engines_.push_back(&engine);
+    }
+    std::thread downloader([&engine] { engine.run(); });
+    size_t index = 0;
+    for (std::vector<std::string> urls = feed(); !urls.empty(); urls = feed()) {
+        for (std::string& url : urls) {
+            Job job;
+            job.index = index++;
+            job.url = std::move(url);
+            if (isS3Url(job.url) || !localPathOf(job.url).empty()) {
+                if (progress_) progress_->skip(Stage::Download);
+                push(std::move(job));
+                continue;
+            }
+            std::string file = downloadPath(prefix, job.index + 1);
+            engine.submit(job.url, file,
+                          [this, push, job](const DownloadResult& result) mutable {
+                              if (progress_) {
+                                  progress_->add(Stage::Download, result.ok, result.bytes);
+                              }
+                              job.download = result;
+                              push(std::move(job));
+                          },
+                          job.index + 1);
+        }
+    }
+    engine.close();
+    downloader.join();
+    {
+        std::lock_guard<std::mutex> lock(enginesMutex_);
+        engines_.erase(std::find(engines_.begin(), engines_.end(), &engine));
+        hostMetrics_ = engine.hostMetrics();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+    ready.notify_all();
+    for (std::thread& worker : workers) worker.join();
+}
+
+/**
+ * @brief Reads, transforms and stores an image of a batch
+ *
+ * @param job Image to process
+ * @param prefix Prefix of the names of the downloads of the batch
+ * @return Processed image
+ */
+ProcessedImage Pipeline::processJob(Job& job, const std::string& prefix) const {
+    ProcessedImage image;
+    image.index = job.index;
+    ImageResult& result = image.result;
+    result.url = job.url;
+    uint64_t id = job.index + 1;
+    bool downloaded = !job.download.url.empty();
+    std::string file;
+    if (downloaded) {
+        file = downloadPath(prefix, id);
+        result.wait = job.download.wait;
+        result.seconds[(int)Stage::Download] = job.download.seconds;
+    }
+
+    // Downloads and local files are mapped instead of read into a buffer
+    std::unique_ptr<MappedFile> mapped;
+    std::vector<unsigned char> original;
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    bool read = false;
+    {
+        // Images that failed to be downloaded also fail to be read
+        StageScope reading(progress_, Stage::Read);
+        if (downloaded && !job.download.ok) {
+            result.error = "unable to download";
+        } else {
+            TaskScope task(Task::Read);
+            std::string path = downloaded ? file : localPathOf(job.url);
+            if (!path.empty()) {
+                mapped = std::make_unique<MappedFile>(path);
+                read = mapped->valid();
+            } else {
+                read = readS3Url(job.url, original);
+            }
+            if (read) {
+                data = mapped ? mapped->data() : original.data();
+                size = mapped ? mapped->size() : original.size();
+            }
+            // Staged downloads are kept in the storage of the originals
+            if (read && downloaded && downloads_ && originals_) {
+                TaskScope writing(Task::Write);
+                std::string key = std::to_string(id) + PIPELINE_ORIGINALS_FORMAT;
+                PROBE_START(write, id, size);
+                bool stored = originals_->put(key, data, size);
+                PROBE_DONE(write, id, size, stored);
+                if (!stored) LOG_ERROR("unable to write " << originals_->name() << key);
+            }
+            result.seconds[(int)Stage::Read] = reading.seconds();
+            if (!read) result.error = "unable to read";
+        }
+        if (!read) reading.fail();
+        reading.setBytes(size);
+    }
+
+    if (read) {
+        result.inputBytes = size;
+        image.format = imageFormat(data, size);
+        StageScope converting(progress_, Stage::Convert);
+        converting.setBytes(size);
+        result.ok = encode(data, size, image, id);
+        result.seconds[(int)Stage::Convert] = converting.seconds();
+        if (!result.ok) converting.fail();
+    }
+
+    if (result.ok && output_) {
+        StageScope uploading(progress_, Stage::Upload);
+        TaskScope task(Task::Write);
+        std::string key = std::to_string(id) + format_;
+        result.output = output_->name() + key;
+        uploading.setBytes(image.data.size());
+        PROBE_START(write, id, image.data.size());
+        result.ok = output_->put(key, image.data.data(), image.data.size());
+        PROBE_DONE(write, id, image.data.size(), result.ok);
+        result.seconds[(int)Stage::Upload] = uploading.seconds();
+        if (!result.ok) {
+            uploading.fail();
+            result.error = "unable to write";
+        }
+    }
+
+    mapped.reset();
+    // Downloads made directly into the storage of the originals are kept
+    if (downloaded && downloads_ && !keepDownloads_) removeDownload(file);
+    image.download = std::move(job.download);
+    return image;
+}
+
+/**
+ * @brief Retrieves the file an image of a batch is downloaded into
+ *
+ * @param prefix Prefix of the names of the downloads of the batch
+ * @param id Number of the image
+ * @return Path to the file, in the staging directory or in the (local)
+ *         storage of the originals
+ */
+std::string Pipeline::downloadPath(const std::string& prefix, uint64_t id) const {
+    if (downloads_) return downloads_->localPath(prefix + std::to_string(id));
+    return originals_->localPath(std::to_string(id) + PIPELINE_ORIGINALS_FORMAT);
+}
+
+/**
+ * @brief Sums a gauge of the download engines of the batches in progress
+ *
+ * @param gauge Gauge of an engine (e.g., DownloadEngine::inFlight)
+ * @return Sum of the gauge
+ */
+size_t Pipeline::engineGauge(size_t (DownloadEngine::*gauge)() const) const {
+    std::lock_guard<std::mutex> lock(enginesMutex_);
+    size_t sum = 0;
+    for (const DownloadEngine* engine : engines_) sum += (engine->*gauge)();
+    return sum;
+}
+
+/**
+ * @brief Decodes an image, applies the transformations and encodes it
+ *
+ * @param data Encoded image
+ * @param size Size of the encoded image
+ * @param image Processed image, receiving the encoded image and its dimensions
+ * @param id Number of the image, passed to the tracepoints
+ * @return true if the image was processed, false otherwise (with the
+ *         reason in the error of the result of the image)
+ */
+bool Pipeline::encode(const unsigned char* data, size_t size, ProcessedImage& image,
+                      uint64_t id) const {
+    ImageResult& result = image.result;
+    // OpenCV wraps the encoded image into a single row of int columns
+    if (size == 0 || size > (size_t)INT_MAX) {
+        result.error = size == 0 ? "unable to decode: empty image" : "unable to decode: too large";
+        return false;
+    }
+    // OpenCV (and transformations) throw on some inputs (e.g., truncated
+    // images), which must fail the image instead of the thread processing it
+    const char* step = "decode";
+    try {
+        cv::Mat decoded;
+        {
+            TaskScope task(Task::Decode);
+            PROBE_START(decode, id, size);
+            cv::Mat encoded(1, (int)size, CV_8U, (void*)data);
+            decoded = cv::imdecode(encoded, cv::IMREAD_COLOR);
+            PROBE_DONE(decode, id, decoded.total() * decoded.elemSize(), !decoded.empty());
+        }
+        if (decoded.empty()) {
+            result.error = "unable to decode";
+            return false;
+        }
+        result.width = decoded.cols;
+        result.height = decoded.rows;
+        cv::Mat transformed;
+        bool ok;
+        step = "transform";
+        {
+            TaskScope task(Task::Convert);
+            PROBE_START(convert, id, decoded.total() * decoded.elemSize());
+            ok = apply(decoded, transformed);
+            PROBE_DONE(convert, id, transformed.total() * transformed.elemSize(), ok);
+        }
+        if (!ok) {
+            result.error = "unable to transform";
+            return false;
+        }
+        step = "encode";
+        TaskScope task(Task::Encode);
+        PROBE_START(encode, id, transformed.total() * transformed.elemSize());
+        ok = cv::imencode(format_, transformed, image.data);
+        PROBE_DONE(encode, id, image.data.size(), ok);
+        result.outputBytes = image.data.size();
+        if (!ok) result.error = "unable to encode";
+        return ok;
+    } catch (const std::exception& e) {
+        std::string message = e.what();
+        while (!message.empty() && isspace((unsigned char)message.back())) message.pop_back();
+        result.error = std::string("unable to ") + step + ": " + message;
+        image.data.clear();
+        return false;
+    }
+}
@@ -0,0 +1,204 @@
+/**
+ * @file	profiler.cpp
+ * @brief	Sampling profiler writing folded stacks for flame graphs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "profiler.h"
+
+#include <cxxabi.h>
+#include <dlfcn.h>
+#include <execinfo.h>
+#include <sys/time.h>
+
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "log.h"
+#include "task.h"
+
+namespace {
+
+/** @brief Profiler receiving the samples, set while sampling */
+std::atomic<Profiler*> active{nullptr};
+
+/** @brief Frames of the signal handler itself (handler and signal trampoline) */
+const int HANDLER_FRAMES = 2;
+
+/**
+ * @brief Names the function containing a return address
+ *
+ * @param address Return address
+ * @return Demangled name of the function, or module+offset if unknown
+ */
+std::string frameName(uintptr_t address) {
+    // A return address may be just past its function, so look up the call
+    void* call = (void*)(address - 1);
+    Dl_info info;
+    if (!dladdr(call, &info)) {
+        char text[32];
+        snprintf(text, sizeof(text), "%#lx", (unsigned long)address);
+        return text;
+    }
+    if (info.dli_sname) {
+        int status = 0;
+        char* demangled = abi::__cxa_demangle(info.dli_sname, nullptr, nullptr, &status);
+        std::string name = status == 0 && demangled ? demangled : info.dli_sname;
+        free(demangled);
+        return name;
+    }
+    const char* module = info.dli_fname ? strrchr(info.dli_fname, '/') : nullptr;
+    module = module ? module + 1 : (info.dli_fname ? info.dli_fname : "?");
+    char text[32];
+    snprintf(text, sizeof(text), "+%#lx", (unsigned long)(address - (uintptr_t)info.dli_fbase));
+    return module + std::string(text);
+}
+
+}  // namespace
+
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+bool Profiler::start(int hz) {
+    if (hz <= 0 || active.load()) return false;
+    if (!samples_) samples_ = std::make_unique<Sample[]>(PROFILER_BUFFER_SIZE);
+    // The first call of backtrace() loads the unwinder, which must not
+    // happen in the signal handler
+    void* frames[1];
+    backtrace(frames, 1);
+
+    active.store(this);
+    struct sigaction action;
+    memset(&action, 0, sizeof(action));
+    action.sa_sigaction = handler;
+    action.sa_flags = SA_SIGINFO | SA_RESTART;
+    sigemptyset(&action.sa_mask);
+    if (sigaction(SIGPROF, &action, nullptr) != 0) {
+        active.store(nullptr);
+        return false;
+    }
+    stop_ = false;
+    drainer_ = std::thread([this] { run(); });
+
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = hz > 1 ? 1000000 / hz : 999999;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        LOG_ERROR("unable to start the profiler: " << strerror(errno));
+        stop();
+        return false;
+    }
+    return true;
+}
+
+void Profiler::stop() {
+    if (!active.load()) return;
+    struct itimerval timer;
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    // A signal still pending must not terminate the process (the default action)
+    signal(SIGPROF, SIG_IGN);
+    active.store(nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stop_ = true;
+    }
+    stopped_.notify_one();
+    drainer_.join();
+    drain();
+}
+
+bool Profiler::write(const std::string& filename) {
+    FILE* file = fopen(filename.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("unable to write " << filename << " file");
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(drainMutex_);
+    std::map<uintptr_t, std::string> names;
+    for (const auto& [stack, count] : stacks_) {
+        // Stacks are recorded from the innermost frame and written from the root
+        std::string line = taskName((Task)stack[0]);
+        for (size_t i = stack.size(); i-- > 1;) {
+            auto name = names.find(stack[i]);
+            if (name == names.end()) name = names.emplace(stack[i], frameName(stack[i])).first;
+            line += ';';
+            line += name->second;
+        }
+        fprintf(file, "%s %llu\n", line.c_str(), (unsigned long long)count);
+    }
+    bool ok = fclose(file) == 0;
+    uint64_t dropped = dropped_.load();
+    LOG_INFO("Profiler: " << total_ << " samples of " << stacks_.size() << " stacks written to "
+             << filename << (dropped > 0 ? ", " + std::to_string(dropped) + " dropped" : ""));
+    return ok;
+}
+
+/**
+ * @brief Records the stack of the interrupted thread
+ * @details It only uses async-signal-safe operations: lock-free atomics,
+ *          a thread-local read and backtrace(), whose unwinder is loaded
+ *          beforehand
+ *
+ * @param signal Signal number (SIGPROF)
+ * @param info Information about the signal
+ * @param context Context of the interrupted thread
+ */
+void Profiler::handler(int, siginfo_t*, void*) {
+    Profiler* profiler = active.load(std::memory_order_acquire);
+    if (!profiler) return;
+    int saved = errno;
+    uint64_t head = profiler->head_.load(std::memory_order_relaxed);
+    do {
+        if (head - profiler->tail_.load(std::memory_order_acquire) >= PROFILER_BUFFER_SIZE) {
+            profiler->dropped_.fetch_add(1, std::memory_order_relaxed);
+            errno = saved;
+            return;
+        }
+    } while (!profiler->head_.compare_exchange_weak(head, head + 1, std::memory_order_acq_rel));
+
+    Sample& sample = profiler->samples_[head % PROFILER_BUFFER_SIZE];
+    sample.task = (int)currentTask();
+    sample.depth = backtrace(sample.frames, PROFILER_MAX_DEPTH);
+    sample.ready.store(true, std::memory_order_release);
+    errno = saved;
+}
+
+/** @brief Aggregates the buffered samples every PROFILER_DRAIN_MS until stopped */
+void Profiler::run() {
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stopped_.wait_for(lock, std::chrono::milliseconds(PROFILER_DRAIN_MS),
+                              [this] { return stop_; })) {
+        lock.unlock();
+        drain();
+        lock.lock();
+    }
+}
+
+/** @brief Aggregates the samples buffered so far by task and stack */
+void Profiler::drain() {
+    std::lock_guard<std::mutex> lock(drainMutex_);
+    uint64_t tail = tail_.load(std::memory_order_relaxed);
+    uint64_t head = head_.load(std::memory_order_acquire);
+    for (; tail != head; tail++) {
+        Sample& sample = samples_[tail % PROFILER_BUFFER_SIZE];
+        // A sample still being written is aggregated next time
+        if (!sample.ready.load(std::memory_order_acquire)) break;
+        std::vector<uintptr_t> stack{(uintptr_t)sample.task};
+        for (int i = HANDLER_FRAMES; i < sample.depth; i++) {
+            stack.push_back((uintptr_t)sample.frames[i]);
+        }
+        stacks_[stack]++;
+        total_++;
+        sample.ready.store(false, std::memory_order_relaxed);
+        tail_.store(tail + 1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,306 @@
+/**
+ * @file	progress.cpp
+ * @brief	Live progress, throughput and utilization of the pipeline stages
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "progress.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include "log.h"
+
+namespace {
+
+/** @brief Names of the stages */
+const char* const STAGE_NAMES[STAGE_COUNT] = {"source", "download", "read", "convert",
+                                              "upload"};
+
+/**
+ * @brief Formats a duration as [H:]MM:SS
+ *
+ * @param seconds Duration in seconds
+ * @return Formatted duration
+ */
+std::string formatDuration(double seconds) {
+    long total = (long)(seconds + 0.5);
+    char text[32];
+    if (total >= 3600) {
+        snprintf(text, sizeof(text), "%ld:%02ld:%02ld", total / 3600, total / 60 % 60,
+                 total % 60);
+    } else {
+        snprintf(text, sizeof(text), "%02ld:%02ld", total / 60, total % 60);
+    }
+    return text;
+}
+
+}  // namespace
+
+const char* stageName(Stage stage) {
+    return STAGE_NAMES[(int)stage];
+}
+
+Progress::Scope::Scope(Progress& progress, Stage stage) : progress_(progress), stage_(stage) {
+    progress_.stages_[(int)stage_].active.fetch_add(1, std::memory_order_relaxed);
+}
+
+Progress::Scope::~Scope() {
+    Counters& counters = progress_.stages_[(int)stage_];
+    (failed_ ? counters.failed : counters.done).fetch_add(items_, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes_, std::memory_order_relaxed);
+    counters.active.fetch_sub(1, std::memory_order_relaxed);
+}
+
+Progress::Progress(size_t total) : total_(total), started_(Clock::now()) {
+    for (int i = 0; i < STAGE_COUNT; i++) pools_[i] = i;
+}
+
+Progress::~Progress() {
+    if (reporter_.joinable()) stop();
+}
+
+void Progress::setWorkers(Stage stage, size_t workers) {
+    stages_[(int)stage].workers.store(workers, std::memory_order_relaxed);
+}
+
+void Progress::setPool(Stage stage, Gauge busy, Gauge workers) {
+    // Set before start(), so the reporter never reads them while being written
+    stages_[(int)stage].busyGauge = std::move(busy);
+    stages_[(int)stage].workersGauge = std::move(workers);
+}
+
+void Progress::shareWorkers(Stage first, Stage last) {
+    for (int i = (int)first; i <= (int)last; i++) pools_[i] = (int)first;
+}
+
+void Progress::add(Stage stage, bool ok, uint64_t bytes) {
+    Counters& counters = stages_[(int)stage];
+    (ok ? counters.done : counters.failed).fetch_add(1, std::memory_order_relaxed);
+    counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+void Progress::skip(Stage stage, size_t items) {
+    stages_[(int)stage].skipped.fetch_add(items, std::memory_order_relaxed);
+}
+
+void Progress::start(bool reporting) {
+    started_ = Clock::now();
+    reporting_ = reporting;
+    reporter_ = std::thread([this] { run(); });
+}
+
+void Progress::stop() {
+    {
+        std::lock_guard<std::mutex> lock(stopMutex_);
+        stop_ = true;
+    }
+    stopped_.notify_one();
+    reporter_.join();
+    if (!reporting_) return;
+    Logger::instance().setStatus("");
+    LOG_INFO(report());
+}
+
+std::vector<PoolLoad> Progress::loads() {
+    std::vector<PoolLoad> loads;
+    std::lock_guard<std::mutex> lock(samplesMutex_);
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (pools_[i] != i) continue;
+        const Totals& totals = totals_[i];
+        PoolLoad load;
+        load.first = load.last = (Stage)i;
+        while ((int)load.last + 1 < STAGE_COUNT && pools_[(int)load.last + 1] == i) {
+            load.last = (Stage)((int)load.last + 1);
+        }
+        const Counters& counters = stages_[i];
+        load.items = counters.done.load(std::memory_order_relaxed) +
+                     counters.failed.load(std::memory_order_relaxed);
+        if (load.items == 0) continue;
+        loads.push_back(load);
+        // Pools faster than the sampling interval are never seen busy
+        if (totals.active <= 0) continue;
+        load.activeSeconds = totals.active;
+        load.saturatedSeconds = totals.saturated;
+        load.busy = totals.busy / totals.active;
+        load.workers = totals.workers / totals.active;
+        load.queued = totals.queued / totals.active;
+        for (int j = i; j <= (int)load.last; j++) {
+            load.share[j] = totals.busy > 0 ? totals_[j].stageBusy / totals.busy : 0;
+        }
+        loads.back() = load;
+    }
+    return loads;
+}
+
+double Progress::sampledSeconds() {
+    std::lock_guard<std::mutex> lock(samplesMutex_);
+    return sampledSeconds_;
+}
+
+std::string Progress::report() {
+    Sample last = sample();
+    Sample first = last;
+    double busy[STAGE_COUNT] = {};
+    size_t samples = 0;
+    {
+        std::lock_guard<std::mutex> lock(samplesMutex_);
+        if (!samples_.empty()) first = samples_.front();
+        for (const Sample& sample : samples_) {
+            for (int i = 0; i < STAGE_COUNT; i++) busy[i] += sample.busy[i];
+            samples++;
+        }
+    }
+    for (int i = 0; i < STAGE_COUNT; i++) busy[i] = samples > 0 ? busy[i] / samples : 0;
+    double seconds = std::chrono::duration<double>(last.time - first.time).count();
+
+    // The bottleneck is the stage whose workers were the busiest
+    int bottleneck = -1;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (busy[i] > 0 && (bottleneck < 0 || busy[i] > busy[bottleneck])) bottleneck = i;
+    }
+
+    // Items leave the batch when uploaded or when they fail to be read (also
+    // if they failed to be downloaded), converted or uploaded
+    uint64_t finished = last.done[(int)Stage::Upload];
+    for (int i = (int)Stage::Read; i < STAGE_COUNT; i++) {
+        finished += stages_[i].failed.load(std::memory_order_relaxed);
+    }
+    finished = std::min<uint64_t>(finished, total_);
+
+    char text[96];
+    snprintf(text, sizeof(text), "%llu/%zu (%.0f%%)", (unsigned long long)finished, total_,
+             total_ > 0 ? 100.0 * finished / total_ : 100.0);
+    std::string line = text;
+    // Stages overlap, so the batch finishes with its slowest stage
+    double eta = -1;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        const Counters& counters = stages_[i];
+        uint64_t failed = counters.failed.load(std::memory_order_relaxed);
+        uint64_t skipped = counters.skipped.load(std::memory_order_relaxed);
+        double rate = seconds > 0 ? (last.done[i] - first.done[i]) / seconds : 0;
+        snprintf(text, sizeof(text), " | %s%s %llu", bottleneck == i ? "*" : "", STAGE_NAMES[i],
+                 (unsigned long long)last.done[i]);
+        line += text;
+        if (failed > 0) {
+            snprintf(text, sizeof(text), " (%llu failed)", (unsigned long long)failed);
+            line += text;
+        }
+        snprintf(text, sizeof(text), " %.1f/s %.0f%%", rate, 100 * busy[i]);
+        line += text;
+
+        uint64_t handled = last.done[i] + failed + skipped;
+        if (rate > 0 && handled < total_) eta = std::max(eta, (total_ - handled) / rate);
+    }
+    int download = (int)Stage::Download;
+    double downloadRate =
+        seconds > 0 ? (last.bytes[download] - first.bytes[download]) / seconds : 0;
+    snprintf(text, sizeof(text), " | %.1f MB/s", downloadRate / (1024 * 1024));
+    line += text;
+    if (finished == total_) {
+        double elapsed = std::chrono::duration<double>(last.time - started_).count();
+        line += " | done in " + formatDuration(elapsed);
+    } else {
+        line += " | ETA " + (eta < 0 ? std::string("--:--") : formatDuration(eta));
+    }
+    return line;
+}
+
+/** @brief Samples the counters until stopped, reporting the progress periodically */
+void Progress::run() {
+    bool interactive = Logger::instance().interactive();
+    Clock::time_point lastReport = Clock::now();
+    Clock::time_point lastSample = started_;
+    auto interval = std::chrono::milliseconds(interactive ? PROGRESS_INTERVAL_MS
+                                                          : PROGRESS_LOG_INTERVAL_MS);
+    std::unique_lock<std::mutex> lock(stopMutex_);
+    while (!stopped_.wait_for(lock, std::chrono::milliseconds(PROGRESS_SAMPLE_MS),
+                              [this] { return stop_; })) {
+        lock.unlock();
+        Sample sample = this->sample();
+        {
+            std::lock_guard<std::mutex> samplesLock(samplesMutex_);
+            samples_.push_back(sample);
+            while (sample.time - samples_.front().time >
+                   std::chrono::milliseconds(PROGRESS_WINDOW_MS)) {
+                samples_.pop_front();
+            }
+            accumulate(sample, std::chrono::duration<double>(sample.time - lastSample).count());
+        }
+        lastSample = sample.time;
+        if (reporting_ && sample.time - lastReport >= interval) {
+            if (interactive) {
+                Logger::instance().setStatus(report());
+            } else {
+                LOG_INFO(report());
+            }
+            lastReport = sample.time;
+        }
+        lock.lock();
+    }
+}
+
+/**
+ * @brief Takes a snapshot of the counters and of the busy workers of each stage
+ *
+ * @return Snapshot
+ */
+Progress::Sample Progress::sample() {
+    Sample sample;
+    sample.time = Clock::now();
+    // Items handled by each stage, and by the previous one, are those that reached it
+    int64_t handled[STAGE_COUNT];
+    int64_t left[STAGE_COUNT];
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        const Counters& counters = stages_[i];
+        sample.done[i] = counters.done.load(std::memory_order_relaxed);
+        sample.bytes[i] = counters.bytes.load(std::memory_order_relaxed);
+        size_t busy = counters.busyGauge ? counters.busyGauge()
+                                         : counters.active.load(std::memory_order_relaxed);
+        size_t workers = counters.workersGauge
+                             ? counters.workersGauge()
+                             : counters.workers.load(std::memory_order_relaxed);
+        sample.busy[i] = workers > 0 ? std::min(1.0, (double)busy / workers) : 0;
+        sample.active[i] = busy;
+        sample.workers[i] = workers;
+
+        uint64_t failed = counters.failed.load(std::memory_order_relaxed);
+        handled[i] = (int64_t)(sample.done[i] + failed +
+                               counters.skipped.load(std::memory_order_relaxed));
+        // Items failing to be read, converted or uploaded leave the batch
+        left[i] = i >= (int)Stage::Read ? (int64_t)failed : 0;
+    }
+    // The source is not fed by another stage
+    sample.queued[0] = 0;
+    for (int i = 1; i < STAGE_COUNT; i++) {
+        int64_t waiting = handled[i - 1] - left[i - 1] - handled[i] - (int64_t)sample.active[i];
+        sample.queued[i] = (uint64_t)std::max<int64_t>(waiting, 0);
+    }
+    return sample;
+}
+
+/**
+ * @brief Adds a sample to the totals of each stage and pool
+ * @details It must be called with samplesMutex_ locked
+ *
+ * @param sample Sample
+ * @param seconds Time (in seconds) since the previous sample
+ */
+void Progress::accumulate(const Sample& sample, double seconds) {
+    sampledSeconds_ += seconds;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        totals_[i].stageBusy += sample.active[i] * seconds;
+        if (pools_[i] != i) continue;
+        size_t busy = 0;
+        for (int j = i; j < STAGE_COUNT && pools_[j] == i; j++) busy += sample.active[j];
+        if (busy == 0) continue;
+        Totals& totals = totals_[i];
+        totals.active += seconds;
+        if (busy >= sample.workers[i]) totals.saturated += seconds;
+        totals.busy += busy * seconds;
+        totals.workers += sample.workers[i] * seconds;
+        totals.queued += sample.queued[i] * seconds;
+    }
+}
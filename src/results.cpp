@@ -0,0 +1,49 @@
+/**
+ * @file	results.cpp
+ * @brief	Stream of the results of each image, as JSON lines
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "results.h"
+
+// Include the single-header JSON library (json.hpp downloaded locally)
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "log.h"
+
+ResultStream::ResultStream(const std::string& path)
+    : file_(path == "-" ? stdout : fopen(path.c_str(), "w")), owned_(path != "-") {
+    if (!file_) LOG_ERROR("unable to write " << path << " file");
+}
+
+ResultStream::~ResultStream() {
+    if (file_ && owned_) fclose(file_);
+}
+
+void ResultStream::write(const ImageResult& result) {
+    json line = {{"url", result.url}, {"ok", result.ok}};
+    if (result.ok) line["output"] = result.output;
+    if (!result.error.empty()) line["error"] = result.error;
+    if (!result.sha256.empty()) line["sha256"] = result.sha256;
+    if (result.width > 0) {
+        line["width"] = result.width;
+        line["height"] = result.height;
+    }
+    line["input_bytes"] = result.inputBytes;
+    line["output_bytes"] = result.outputBytes;
+    json timings = json::object();
+    if (result.wait >= 0) timings["queue"] = result.wait;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (result.seconds[i] >= 0) timings[stageName((Stage)i)] = result.seconds[i];
+    }
+    line["seconds"] = timings;
+    std::string text = line.dump(-1, ' ', false, json::error_handler_t::replace) + "\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!file_) return;
+    fwrite(text.data(), 1, text.size(), file_);
+    fflush(file_);
+}
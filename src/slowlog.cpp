@@ -0,0 +1,139 @@
+/**
+ * @file	slowlog.cpp
+ * @brief	Log of the images whose stages were outliers, with diagnostics
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "slowlog.h"
+
+#include <algorithm>
+#include <cstring>
+
+// Include the single-header JSON library (json.hpp downloaded locally)
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "log.h"
+
+namespace {
+
+/**
+ * @brief Converts the timing of a request to JSON
+ *
+ * @param timing Timing of the request
+ * @return JSON object
+ */
+json timingToJson(const RequestTiming& timing) {
+    json object = {{"name_lookup", timing.nameLookup},
+                   {"connect", timing.connect},
+                   {"tls_handshake", timing.tlsHandshake},
+                   {"pre_transfer", timing.preTransfer},
+                   {"first_byte", timing.firstByte},
+                   {"total", timing.total},
+                   {"status", timing.status},
+                   {"http_version", timing.httpVersion}};
+    if (!timing.error.empty()) object["error"] = timing.error;
+    return object;
+}
+
+}  // namespace
+
+SlowLog::SlowLog(const std::string& path, double factor)
+    : file_(fopen(path.c_str(), "w")), factor_(factor) {
+    if (!file_) LOG_ERROR("unable to write " << path << " file");
+}
+
+SlowLog::~SlowLog() {
+    if (file_) fclose(file_);
+}
+
+bool SlowLog::observe(const ImageResult& result, const DownloadResult* download,
+                      const std::string& format) {
+    json slow = json::array();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (int i = 0; i < STAGE_COUNT; i++) {
+            double seconds = result.seconds[i];
+            if (seconds < 0) continue;
+            Window& window = windows_[i];
+            // The image is compared with the images before it
+            if (window.times.size() >= SLOW_LOG_MIN_SAMPLES) {
+                double p99 = percentile(window);
+                if (seconds > factor_ * p99) {
+                    slow.push_back({{"stage", stageName((Stage)i)},
+                                    {"seconds", seconds},
+                                    {"p99", p99},
+                                    {"threshold", factor_ * p99}});
+                }
+            }
+            if (window.times.size() < SLOW_LOG_WINDOW) {
+                window.times.push_back(seconds);
+            } else {
+                window.times[window.next] = seconds;
+            }
+            window.next = (window.next + 1) % SLOW_LOG_WINDOW;
+        }
+    }
+    if (slow.empty() || !file_) return !slow.empty();
+
+    json record = {{"url", result.url}, {"ok", result.ok}, {"slow", slow}};
+    if (!result.error.empty()) record["error"] = result.error;
+    json seconds = json::object();
+    if (result.wait >= 0) seconds["queue"] = result.wait;
+    for (int i = 0; i < STAGE_COUNT; i++) {
+        if (result.seconds[i] >= 0) seconds[stageName((Stage)i)] = result.seconds[i];
+    }
+    record["seconds"] = seconds;
+    record["input_bytes"] = result.inputBytes;
+    record["output_bytes"] = result.outputBytes;
+    if (result.width > 0) {
+        record["width"] = result.width;
+        record["height"] = result.height;
+    }
+    if (!format.empty()) record["format"] = format;
+    if (download) {
+        record["download"] = {{"ok", download->ok},
+                              {"effective_url", download->effectiveUrl},
+                              {"attempts", download->attempts},
+                              {"bytes", download->bytes},
+                              {"probe", timingToJson(download->probe)},
+                              {"slowest_request", timingToJson(download->slowest)},
+                              {"headers", download->headers}};
+    }
+    std::string line = record.dump(-1, ' ', false, json::error_handler_t::replace) + "\n";
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    fwrite(line.data(), 1, line.size(), file_);
+    fflush(file_);
+    return true;
+}
+
+/**
+ * @brief Computes the 99th percentile of the times of a stage
+ * @details It must be called with mutex_ locked
+ *
+ * @param window Latest times of the stage
+ * @return 99th percentile
+ */
+double SlowLog::percentile(const Window& window) const {
+    std::vector<double> times = window.times;
+    auto nth = times.begin() + (times.size() - 1) * 99 / 100;
+    std::nth_element(times.begin(), nth, times.end());
+    return *nth;
+}
+
+std::string imageFormat(const unsigned char* data, size_t size) {
+    auto startsWith = [data, size](const char* signature, size_t length, size_t offset = 0) {
+        return size >= offset + length && memcmp(data + offset, signature, length) == 0;
+    };
+    if (startsWith("\xFF\xD8\xFF", 3)) return "jpeg";
+    if (startsWith("\x89PNG\r\n\x1A\n", 8)) return "png";
+    if (startsWith("GIF8", 4)) return "gif";
+    if (startsWith("RIFF", 4) && startsWith("WEBP", 4, 8)) return "webp";
+    if (startsWith("BM", 2)) return "bmp";
+    if (startsWith("II*\0", 4) || startsWith("MM\0*", 4)) return "tiff";
+    if (startsWith("ftypavif", 8, 4)) return "avif";
+    return "";
+}
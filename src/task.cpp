@@ -0,0 +1,48 @@
+/**
+ * @file	task.cpp
+ * @brief	Tag of the task each thread is working on
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "task.h"
+
+#include <atomic>
+
+namespace {
+
+/** @brief Names of the tasks */
+const char* const TASK_NAMES[TASK_COUNT] = {"none",     "gemini", "openai", "crawl",
+                                            "probe",    "download", "read", "decode",
+                                            "convert",  "encode", "write"};
+
+/**
+ * @brief Task of each thread
+ * @details A constant-initialized thread-local in static TLS (initial-exec),
+ *          also when linked into the shared library, so that reading it
+ *          never allocates and it can be read from signal handlers and the
+ *          allocation functions
+ */
+__attribute__((tls_model("initial-exec"))) thread_local volatile int current = (int)Task::None;
+
+}  // namespace
+
+const char* taskName(Task task) {
+    return TASK_NAMES[(int)task];
+}
+
+Task currentTask() {
+    return (Task)current;
+}
+
+TaskScope::TaskScope(Task task) : previous_((Task)current) {
+    current = (int)task;
+    // Keeps the compiler from moving the work of the task across the tag
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+}
+
+TaskScope::~TaskScope() {
+    std::atomic_signal_fence(std::memory_order_seq_cst);
+    current = (int)previous_;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file	tlscache.cpp
+ * @brief	Cache of TLS sessions shared by all HTTPS requests and persisted
+ *          between runs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "tlscache.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <ctime>
+#include <fstream>
+#include <vector>
+
+#include "json.hpp"
+using json = nlohmann::json;
+
+#include "log.h"
+
+/** @brief Whether libcurl can export and import TLS sessions (8.12.0 or later) */
+#define TLS_CACHE_PERSISTENT (LIBCURL_VERSION_NUM >= 0x080c00)
+
+namespace {
+
+/**
+ * @brief Encodes bytes as hexadecimal text
+ *
+ * @param data Bytes to encode
+ * @param size Number of bytes
+ * @return Hexadecimal text
+ */
+[[maybe_unused]] std::string toHex(const unsigned char* data, size_t size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string text;
+    text.reserve(size * 2);
+    for (size_t i = 0; i < size; i++) {
+        text += digits[data[i] >> 4];
+        text += digits[data[i] & 0x0f];
+    }
+    return text;
+}
+
+/**
+ * @brief Decodes hexadecimal text into bytes
+ *
+ * @param text Hexadecimal text
+ * @return Decoded bytes
+ */
+[[maybe_unused]] std::vector<unsigned char> fromHex(const std::string& text) {
+    std::vector<unsigned char> data;
+    data.reserve(text.size() / 2);
+    for (size_t i = 0; i + 1 < text.size(); i += 2) {
+        data.push_back((unsigned char)std::stoi(text.substr(i, 2), nullptr, 16));
+    }
+    return data;
+}
+
+#if TLS_CACHE_PERSISTENT
+/**
+ * @brief A callback for curl_easy_ssls_export() collecting each session
+ *
+ * @param curl Easy handle whose sessions are exported
+ * @param userp Pointer to the JSON array receiving the sessions
+ * @param session_key Key of the session (peer, port and TLS parameters)
+ * @param shmac Salted hash of the key
+ * @param shmac_len Length of the salted hash
+ * @param sdata Serialized session
+ * @param sdata_len Length of the serialized session
+ * @param valid_until Expiration time (seconds since the epoch)
+ * @param ietf_tls_id TLS version of the session
+ * @param alpn Negotiated application protocol
+ * @param earlydata_max Maximum early data (in bytes) the server accepts
+ * @return CURLE_OK
+ */
+CURLcode exportSession(CURL* curl, void* userp, const char* session_key,
+                       const unsigned char* shmac, size_t shmac_len,
+                       const unsigned char* sdata, size_t sdata_len, curl_off_t valid_until,
+                       int ietf_tls_id, const char* alpn, size_t earlydata_max) {
+    (void)curl;
+    (void)session_key;
+    (void)ietf_tls_id;
+    (void)alpn;
+    (void)earlydata_max;
+    if (valid_until <= (curl_off_t)std::time(nullptr)) return CURLE_OK;
+    json* sessions = (json*)userp;
+    sessions->push_back({{"shmac", toHex(shmac, shmac_len)},
+                         {"data", toHex(sdata, sdata_len)},
+                         {"valid_until", valid_until}});
+    return CURLE_OK;
+}
+#endif
+
+}  // namespace
+
+TlsSessionCache& TlsSessionCache::instance() {
+    static TlsSessionCache cache;
+    return cache;
+}
+
+TlsSessionCache::TlsSessionCache() {}
+
+TlsSessionCache::~TlsSessionCache() {
+    release();
+}
+
+void TlsSessionCache::apply(CURL* curl, bool earlyData) {
+    curl_easy_setopt(curl, CURLOPT_SHARE, share());
+    curl_easy_setopt(curl, CURLOPT_SSL_SESSIONID_CACHE, 1L);
+#ifdef CURLSSLOPT_EARLYDATA
+    if (earlyData) curl_easy_setopt(curl, CURLOPT_SSL_OPTIONS, (long)CURLSSLOPT_EARLYDATA);
+#else
+    (void)earlyData;
+#endif
+}
+
+void TlsSessionCache::load(const std::string& filename) {
+#if TLS_CACHE_PERSISTENT
+    std::ifstream in(filename);
+    if (!in) return;
+    CURL* curl = curl_easy_init();
+    if (!curl) return;
+    curl_easy_setopt(curl, CURLOPT_SHARE, share());
+    try {
+        json sessions = json::parse(in);
+        curl_off_t now = (curl_off_t)std::time(nullptr);
+        for (const json& session : sessions) {
+            if (session.at("valid_until").get<curl_off_t>() <= now) continue;
+            std::vector<unsigned char> shmac = fromHex(session.at("shmac").get<std::string>());
+            std::vector<unsigned char> data = fromHex(session.at("data").get<std::string>());
+            curl_easy_ssls_import(curl, nullptr, shmac.data(), shmac.size(), data.data(),
+                                  data.size());
+        }
+    } catch (std::exception&) {
+        // A corrupt cache file is ignored; the handshakes are done again
+    }
+    curl_easy_cleanup(curl);
+#else
+    (void)filename;
+#endif
+}
+
+void TlsSessionCache::save(const std::string& filename) {
+#if TLS_CACHE_PERSISTENT
+    CURL* curl = curl_easy_init();
+    if (!curl) return;
+    curl_easy_setopt(curl, CURLOPT_SHARE, share());
+    json sessions = json::array();
+    CURLcode res = curl_easy_ssls_export(curl, exportSession, &sessions);
+    curl_easy_cleanup(curl);
+    if (res != CURLE_OK) return;
+
+    int fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0600);
+    if (fd < 0) return;
+    std::string text = sessions.dump();
+    if (write(fd, text.data(), text.size()) != (ssize_t)text.size()) {
+        LOG_ERROR("unable to write " << filename << " file");
+    }
+    close(fd);
+#else
+    (void)filename;
+#endif
+}
+
+void TlsSessionCache::release() {
+    std::lock_guard<std::mutex> guard(shareMutex_);
+    // libcurl refuses to release a share handle still used by easy handles
+    if (share_ && curl_share_cleanup(share_) == CURLSHE_OK) share_ = nullptr;
+}
+
+/**
+ * @brief Retrieves the share handle, creating it on first use
+ *
+ * @return Share handle
+ */
+CURLSH* TlsSessionCache::share() {
+    std::lock_guard<std::mutex> guard(shareMutex_);
+    if (!share_) {
+        share_ = curl_share_init();
+        curl_share_setopt(share_, CURLSHOPT_LOCKFUNC, lock);
+        curl_share_setopt(share_, CURLSHOPT_UNLOCKFUNC, unlock);
+        curl_share_setopt(share_, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share_, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+    }
+    return share_;
+}
+
+/**
+ * @brief Locks shared data for libcurl
+ *
+ * @param curl Easy handle requesting the lock
+ * @param data Shared data to lock
+ * @param access Shared or exclusive access (the lock is always exclusive)
+ * @param userp Pointer to the cache
+ */
+void TlsSessionCache::lock(CURL* curl, curl_lock_data data, curl_lock_access access,
+                           void* userp) {
+    (void)curl;
+    (void)access;
+    ((TlsSessionCache*)userp)->locks_[data].lock();
+}
+
+/**
+ * @brief Unlocks shared data for libcurl
+ *
+ * @param curl Easy handle releasing the lock
+ * @param data Shared data to unlock
+ * @param userp Pointer to the cache
+ */
+void TlsSessionCache::unlock(CURL* curl, curl_lock_data data, void* userp) {
+    (void)curl;
+    ((TlsSessionCache*)userp)->locks_[data].unlock();
+}
@@ -0,0 +1,276 @@
+/**
+ * @file	urlsource.cpp
+ * @brief	Sources of the URLs of the images to process
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include "urlsource.h"
+
+#include <curl/curl.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "crawler.h"
+#include "dnscache.h"
+#include "gemini.h"
+#include "log.h"
+#include "mappedfile.h"
+#include "openai.h"
+#include "probes.h"
+#include "task.h"
+#include "tlscache.h"
+
+bool isAccessible(const std::string& url) {
+    TaskScope task(Task::Probe);
+    CURL* curl = curl_easy_init();
+    if (!curl) return false;
+
+    CURLcode res;
+    long response_code = 0;
+
+    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
+    DnsCache::instance().apply(curl, url);
+    TlsSessionCache::instance().apply(curl, true);
+    curl_easy_setopt(curl, CURLOPT_NOBODY, 1L);
+    curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5L);
+    PROBE_START(probe, 0, 0);
+    res = curl_easy_perform(curl);
+    curl_off_t length = 0;
+    if (res == CURLE_OK) {
+        curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+        curl_easy_getinfo(curl, CURLINFO_CONTENT_LENGTH_DOWNLOAD_T, &length);
+    }
+    curl_easy_cleanup(curl);
+
+    bool accessible = res == CURLE_OK && response_code == 200;
+    PROBE_DONE(probe, 0, std::max<curl_off_t>(length, 0), accessible);
+    return accessible;
+}
+
+bool isInputUrl(const std::string& url) {
+    for (const char* scheme : {"http://", "https://", "s3://", "file://"}) {
+        if (url.compare(0, strlen(scheme), scheme) == 0) return true;
+    }
+    return false;
+}
+
+std::vector<std::string> UrlSource::pull(size_t count) {
+    std::vector<std::string> urls;
+    std::future<std::vector<std::string>> prefetched;
+    {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        urls.swap(pending_);
+        prefetched = std::move(prefetched_);
+    }
+    if (prefetched.valid()) {
+        std::vector<std::string> more = prefetched.get();
+        urls.insert(urls.end(), more.begin(), more.end());
+    }
+
+    // Keep what exceeds count for the next pull, or produce what is missing
+    if (urls.size() > count) {
+        std::lock_guard<std::mutex> lock(prefetchMutex_);
+        pending_.insert(pending_.begin(), urls.begin() + count, urls.end());
+        urls.resize(count);
+    } else if (urls.size() < count) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<std::string> more = produceChecked(count - urls.size());
+        urls.insert(urls.end(), more.begin(), more.end());
+    }
+    return urls;
+}
+
+std::future<std::vector<std::string>> UrlSource::pullAsync(size_t count) {
+    return std::async(std::launch::async, [this, count] { return pull(count); });
+}
+
+void UrlSource::prefetch(size_t count) {
+    std::lock_guard<std::mutex> lock(prefetchMutex_);
+    if (prefetched_.valid() || pending_.size() >= count) return;
+    count -= pending_.size();
+    prefetched_ = std::async(std::launch::async, [this, count] {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return produceChecked(count);
+    });
+}
+
+void UrlSource::drain() {
+    std::lock_guard<std::mutex> lock(prefetchMutex_);
+    if (prefetched_.valid()) prefetched_.wait();
+}
+
+/**
+ * @brief Produces the next URLs, dropping those without a supported scheme
+ *        (and, if the source lists local paths, that are not explicit paths)
+ *
+ * @param count Number of URLs wanted
+ * @return URLs produced
+ */
+std::vector<std::string> UrlSource::produceChecked(size_t count) {
+    std::vector<std::string> urls = produce(count);
+    auto unsupported = [this](const std::string& url) {
+        if (isInputUrl(url) || (listsPaths() && !localPathOf(url).empty())) return false;
+        LOG_WARNING(name() << " gave " << url << ", which is not an http(s), s3 or file URL"
+                           << (listsPaths() ? " nor an absolute or ./ path" : ""));
+        return true;
+    };
+    urls.erase(std::remove_if(urls.begin(), urls.end(), unsupported), urls.end());
+    return urls;
+}
+
+std::vector<std::string> PromptUrlSource::produce(size_t count) {
+    std::vector<std::string> image_urls;
+    for (int round = 0; round < URL_SOURCE_MAX_ROUNDS && image_urls.size() < count; round++) {
+        std::ostringstream generationPrompt;
+        generationPrompt << "Generate " << count
+                         << " public domain image URLs (either JPEG or PNG format)" 
+                         << " from trusted public domain image repositories. Exclude"
+                         << " Wikimedia Commons and related sites. The URL must directly"
+                         << " point to a valid image file ending with.jpg or .png, and"
+                         << " the file size must be less than 200 KB. Provide the final"
+                         << " image URLs in plain text.";
+        std::vector<std::string> genTexts =
+            complete(generationPrompt.str(), candidates_);
+
+        std::ostringstream extractionPrompt;
+        extractionPrompt
+            << "Extract all URLs from the following contents into a plain text "
+               "list. Each URL must be on a new line. These are the contents: ";
+        for (const auto& genText : genTexts) {
+            extractionPrompt << genText << "\n\n";
+        }
+        std::vector<std::string> urlsTexts = complete(extractionPrompt.str(), 1);
+        std::string urlsText = urlsTexts.empty() ? "" : urlsTexts.front();
+
+        // Split lines and validate URLs, skipping the ones already seen
+        // (candidates often repeat URLs)
+        std::vector<std::string> candidate_urls;
+        std::istringstream iss(urlsText);
+        std::string line;
+        while (std::getline(iss, line)) {
+            size_t first = line.find_first_not_of(" \t\r");
+            if (first == std::string::npos) continue;
+            line = line.substr(first, line.find_last_not_of(" \t\r") - first + 1);
+            // Models only give web URLs; anything else (e.g., a local file) is ignored
+            bool web = line.compare(0, 7, "http://") == 0 || line.compare(0, 8, "https://") == 0;
+            if (web && seen_.insert(line).second) candidate_urls.push_back(line);
+        }
+
+        if (candidate_urls.empty()) {
+            LOG_WARNING(name() << " gave no new URL");
+            break;
+        }
+
+        // Resolve all hosts of this round at once before checking the URLs
+        DnsCache::instance().prefetch(candidate_urls);
+
+        // Check if URLs are accessible
+        for (const auto& url : candidate_urls) {
+            if (isAccessible(url)) {
+                image_urls.push_back(url);
+                if (image_urls.size() == count) break;
+            }
+        }
+    }
+
+    return image_urls;
+}
+
+GeminiUrlSource::GeminiUrlSource(const std::string& apiKey)
+    : PromptUrlSource(GEMINI_CANDIDATE_COUNT), apiKey_(apiKey) {}
+
+GeminiUrlSource::~GeminiUrlSource() { drain(); }
+
+std::string GeminiUrlSource::name() const { return "Google Gemini"; }
+
+std::vector<std::string> GeminiUrlSource::complete(const std::string& prompt,
+                                                   int candidates) {
+    TaskScope task(Task::Gemini);
+    return extractTextsFromGemini(postToGemini(apiKey_, prompt, candidates));
+}
+
+OpenAiUrlSource::OpenAiUrlSource(const std::string& baseUrl, const std::string& model,
+                                 const std::string& apiKey)
+    : PromptUrlSource(OPENAI_CHOICE_COUNT), baseUrl_(baseUrl), model_(model), apiKey_(apiKey) {}
+
+OpenAiUrlSource::~OpenAiUrlSource() { drain(); }
+
+std::string OpenAiUrlSource::name() const { return model_ + " at " + baseUrl_; }
+
+std::vector<std::string> OpenAiUrlSource::complete(const std::string& prompt,
+                                                   int candidates) {
+    TaskScope task(Task::OpenAi);
+    return extractTextsFromOpenAi(postToOpenAi(baseUrl_, model_, apiKey_, prompt, candidates));
+}
+
+ManifestUrlSource::ManifestUrlSource(const std::string& filename)
+    : filename_(filename), file_(filename) {
+    if (!file_) {
+        LOG_ERROR("unable to read " << filename << " file");
+    }
+}
+
+ManifestUrlSource::~ManifestUrlSource() { drain(); }
+
+std::string ManifestUrlSource::name() const { return filename_; }
+
+std::vector<std::string> ManifestUrlSource::produce(size_t count) {
+    std::vector<std::string> urls;
+    std::string line;
+    while (urls.size() < count && std::getline(file_, line)) {
+        size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') continue;
+        size_t last = line.find_last_not_of(" \t\r");
+        urls.push_back(line.substr(first, last - first + 1));
+    }
+    return urls;
+}
+
+FakeUrlSource::FakeUrlSource(const std::string& baseUrl, size_t limit)
+    : baseUrl_(baseUrl), limit_(limit) {
+    if (!baseUrl_.empty() && baseUrl_.back() == '/') baseUrl_.pop_back();
+}
+
+FakeUrlSource::~FakeUrlSource() { drain(); }
+
+std::string FakeUrlSource::name() const { return "fake URLs at " + baseUrl_; }
+
+std::vector<std::string> FakeUrlSource::produce(size_t count) {
+    std::vector<std::string> urls;
+    while (urls.size() < count && (limit_ == 0 || next_ <= limit_)) {
+        urls.push_back(baseUrl_ + "/" + std::to_string(next_++) + ".jpg");
+    }
+    return urls;
+}
+
+std::unique_ptr<UrlSource> makeUrlSource(const std::string& spec, const std::string& geminiKey,
+                                         const std::string& openAiKey) {
+    size_t equal = spec.find('=');
+    std::string kind = spec.substr(0, equal);
+    std::string arg = equal == std::string::npos ? "" : spec.substr(equal + 1);
+    size_t hash = arg.rfind('#');
+    std::string param = hash == std::string::npos ? "" : arg.substr(hash + 1);
+    std::string location = arg.substr(0, hash);
+
+    if (kind == "gemini" && arg.empty()) {
+        return std::make_unique<GeminiUrlSource>(geminiKey);
+    } else if (kind == "openai") {
+        return std::make_unique<OpenAiUrlSource>(
+            location.empty() ? OPENAI_API_URL : location,
+            param.empty() ? OPENAI_MODEL : param, openAiKey);
+    } else if (kind == "manifest" && !arg.empty()) {
+        return std::make_unique<ManifestUrlSource>(arg);
+    } else if (kind == "crawl" && !location.empty()) {
+        int depth = param.empty() ? CRAWLER_MAX_DEPTH : atoi(param.c_str());
+        return std::make_unique<CrawlerUrlSource>(std::vector<std::string>{location}, depth);
+    } else if (kind == "fake" && !location.empty()) {
+        return std::make_unique<FakeUrlSource>(location, std::strtoul(param.c_str(), nullptr, 10));
+    }
+    LOG_ERROR("unknown URL source " << spec);
+    return nullptr;
+}
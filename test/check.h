@@ -0,0 +1,48 @@
+/**
+ * @file	check.h
+ * @brief	Minimal assertions shared by the tests
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <iostream>
+
+/** @brief Number of checks that failed so far */
+inline int checkFailures = 0;
+
+/**
+ * @brief Checks that a value equals the expected one, reporting both
+ *        otherwise (they must be printable to a stream)
+ */
+#define CHECK_EQUAL(actual, expected)                                                  \
+    do {                                                                               \
+        const auto& actualValue = (actual);                                            \
+        const auto& expectedValue = (expected);                                        \
+        if (!(actualValue == expectedValue)) {                                         \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": " << #actual << " is \""    \
+                      << actualValue << "\", expected \"" << expectedValue << "\""     \
+                      << std::endl;                                                    \
+            checkFailures++;                                                           \
+        }                                                                              \
+    } while (0)
+
+/**
+ * @brief Reports the outcome of the checks of a test
+ *
+ * @param name Name of the test
+ * @return Exit status of the test (0 if every check passed)
+ */
+inline int checkResult(const char* name) {
+    if (checkFailures > 0) {
+        std::cerr << name << ": " << checkFailures << " checks failed" << std::endl;
+        return 1;
+    }
+    std::cout << name << ": passed" << std::endl;
+    return 0;
+}
+
+#endif
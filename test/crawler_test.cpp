@@ -0,0 +1,70 @@
+/**
+ * @file	crawler_test.cpp
+ * @brief	Tests of the streaming scanner of the links of HTML pages
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+
+#include "check.h"
+#include "crawler.h"
+
+/** @brief Page mixing links to report with links hidden in comments and scripts */
+const char* PAGE =
+    "<!DOCTYPE html><html><head><BASE HREF=\"https://a.org/gallery/\">"
+    "<style>a { background: url('<img src=style.jpg>'); }</style></head><body>"
+    "<!-- <img src=\"commented.jpg\"> -->"
+    "<IMG class=photo SRC='1.jpg' alt=\"a > b\"><img data-src=2.jpg>"
+    "<picture><source srcset=\"3-small.webp 480w, 3-large.webp 1024w\"></picture>"
+    "<a href=\"page?id=1&amp;view=full\">next</a><a name=top>top</a>"
+    "<script>document.write('<img src=\"scripted.jpg\">');</script>"
+    "<div data-href=\"div.html\"><img src=4.png/></div></body></html>";
+
+/** @brief Attributes expected from PAGE, as tag attr=value lines */
+const char* EXPECTED =
+    "base href=https://a.org/gallery/\n"
+    "img src=1.jpg\n"
+    "img data-src=2.jpg\n"
+    "source srcset=3-small.webp 480w, 3-large.webp 1024w\n"
+    "a href=page?id=1&view=full\n"
+    "img src=4.png/\n";
+
+/**
+ * @brief Scans a page fed in chunks of a given size
+ *
+ * @param page Page
+ * @param chunk Size of each chunk
+ * @return Attributes reported, as tag attr=value lines
+ */
+std::string scan(const char* page, size_t chunk) {
+    std::string found;
+    HtmlLinkScanner scanner(
+        [&found](const std::string& tag, const std::string& attr, const std::string& value) {
+            found += tag + " " + attr + "=" + value + "\n";
+        });
+    size_t size = strlen(page);
+    for (size_t offset = 0; offset < size; offset += chunk) {
+        scanner.feed(page + offset, std::min(chunk, size - offset));
+    }
+    return found;
+}
+
+/**
+ * @brief Main function
+ *
+ * @return Exit status (0 if every check passed)
+ */
+int main() {
+    // Tags and attributes split across chunks are reported the same way
+    CHECK_EQUAL(scan(PAGE, strlen(PAGE)), EXPECTED);
+    CHECK_EQUAL(scan(PAGE, 1), EXPECTED);
+    CHECK_EQUAL(scan(PAGE, 7), EXPECTED);
+
+    CHECK_EQUAL(scan("<p>1 < 2</p><img src=\"unterminated", 3), "");
+
+    return checkResult("crawler_test");
+}
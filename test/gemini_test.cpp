@@ -0,0 +1,54 @@
+/**
+ * @file	gemini_test.cpp
+ * @brief	Tests of the SAX extraction of text from Google Gemini responses
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <string>
+#include <vector>
+
+#include "check.h"
+#include "gemini.h"
+
+/** @brief Response with two candidates, the first one having two parts */
+const char* RESPONSE = R"({
+  "candidates": [
+    {"content": {"parts": [{"text": "https://a.org/1.jpg\n"}, {"text": "https://a.org/2.jpg"}],
+                 "role": "model"},
+     "finishReason": "STOP", "citationMetadata": {"citations": [{"text": "not a part"}]}},
+    {"content": {"parts": [{"text": "https://b.org/é.png"}], "role": "model"}}
+  ],
+  "usageMetadata": {"text": "not a candidate", "totalTokenCount": 42}
+})";
+
+/**
+ * @brief Main function
+ *
+ * @return Exit status (0 if every check passed)
+ */
+int main() {
+    // The parts of the first candidate are concatenated, and text outside
+    // the path to the parts is ignored
+    CHECK_EQUAL(extractTextFromGemini(RESPONSE), "https://a.org/1.jpg\nhttps://a.org/2.jpg");
+
+    std::vector<std::string> texts = extractTextsFromGemini(RESPONSE);
+    CHECK_EQUAL(texts.size(), 2u);
+    if (texts.size() == 2) {
+        CHECK_EQUAL(texts[0], "https://a.org/1.jpg\nhttps://a.org/2.jpg");
+        CHECK_EQUAL(texts[1], "https://b.org/\xc3\xa9.png");
+    }
+
+    // Only the first candidate is needed, so what follows it is never parsed
+    CHECK_EQUAL(extractTextFromGemini(
+                    R"({"candidates": [{"content": {"parts": [{"text": "first"}]}}, {"trunc)"),
+                "first");
+
+    CHECK_EQUAL(extractTextFromGemini(R"({"candidates": []})"), "");
+    CHECK_EQUAL(extractTextsFromGemini(R"({"error": {"code": 429}})").size(), 0u);
+    CHECK_EQUAL(extractTextFromGemini("not json"), "");
+    CHECK_EQUAL(extractTextsFromGemini(R"({"candidates": [)").size(), 0u);
+
+    return checkResult("gemini_test");
+}
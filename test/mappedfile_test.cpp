@@ -0,0 +1,34 @@
+/**
+ * @file	mappedfile_test.cpp
+ * @brief	Tests of the recognition of the local paths of input URLs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <string>
+
+#include "check.h"
+#include "mappedfile.h"
+
+/**
+ * @brief Main function
+ *
+ * @return Exit status (0 if every check passed)
+ */
+int main() {
+    CHECK_EQUAL(localPathOf("/data/1.jpg"), "/data/1.jpg");
+    CHECK_EQUAL(localPathOf("./1.jpg"), "./1.jpg");
+    CHECK_EQUAL(localPathOf("../images/1.jpg"), "../images/1.jpg");
+    CHECK_EQUAL(localPathOf("file:///data/my%20photo.jpg"), "/data/my photo.jpg");
+    CHECK_EQUAL(localPathOf("file://localhost/data/1.jpg"), "/data/1.jpg");
+
+    // Anything else is not taken for a file, so that a mistyped URL fails
+    CHECK_EQUAL(localPathOf("images/1.jpg"), "");
+    CHECK_EQUAL(localPathOf("http:/host/1.jpg"), "");
+    CHECK_EQUAL(localPathOf("https://host/1.jpg"), "");
+    CHECK_EQUAL(localPathOf("s3://bucket/1.jpg"), "");
+    CHECK_EQUAL(localPathOf(""), "");
+
+    return checkResult("mappedfile_test");
+}
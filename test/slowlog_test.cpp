@@ -0,0 +1,46 @@
+/**
+ * @file	slowlog_test.cpp
+ * @brief	Tests of the recognition of the format of encoded images
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <string>
+
+#include "check.h"
+#include "slowlog.h"
+
+/**
+ * @brief Recognizes the format of an image from the first bytes of a string
+ *
+ * @param data First bytes of the image
+ * @return Format, or an empty string if unknown
+ */
+std::string formatOf(const std::string& data) {
+    return imageFormat((const unsigned char*)data.data(), data.size());
+}
+
+/**
+ * @brief Main function
+ *
+ * @return Exit status (0 if every check passed)
+ */
+int main() {
+    CHECK_EQUAL(formatOf(std::string("\xFF\xD8\xFF\xE0\0\x10JFIF", 10)), "jpeg");
+    CHECK_EQUAL(formatOf("\x89PNG\r\n\x1A\n"), "png");
+    CHECK_EQUAL(formatOf("GIF89a"), "gif");
+    CHECK_EQUAL(formatOf(std::string("RIFF\x24\0\0\0WEBPVP8 ", 16)), "webp");
+    CHECK_EQUAL(formatOf("BM6"), "bmp");
+    CHECK_EQUAL(formatOf(std::string("II*\0", 4)), "tiff");
+    CHECK_EQUAL(formatOf(std::string("MM\0*", 4)), "tiff");
+    CHECK_EQUAL(formatOf(std::string("\0\0\0\x1C" "ftypavif", 12)), "avif");
+
+    // Signatures cut short or unknown
+    CHECK_EQUAL(formatOf("\x89PNG"), "");
+    CHECK_EQUAL(formatOf(std::string("RIFF\x24\0\0\0WAVE", 12)), "");
+    CHECK_EQUAL(formatOf("<html>"), "");
+    CHECK_EQUAL(formatOf(""), "");
+
+    return checkResult("slowlog_test");
+}
@@ -0,0 +1,51 @@
+/**
+ * @file	storage_test.cpp
+ * @brief	Tests of the helpers of the storage backends: SHA-256 digests
+ *          (known answers of FIPS 180-2) and recognition of S3 URLs
+ * @author	Everton Cavalcante (everton.cavalcante@ufrn.br)
+ * @since	October 18, 2026
+ * @date	October 18, 2026
+ */
+
+#include <string>
+
+#include "check.h"
+#include "storage.h"
+
+/**
+ * @brief Computes the SHA-256 digest of a string
+ *
+ * @param text String
+ * @return Digest, in hexadecimal
+ */
+std::string digest(const std::string& text) {
+    return sha256((const unsigned char*)text.data(), text.size());
+}
+
+/**
+ * @brief Main function
+ *
+ * @return Exit status (0 if every check passed)
+ */
+int main() {
+    // Known answers of FIPS 180-2: the empty message, one block, two blocks
+    // and a million bytes
+    CHECK_EQUAL(sha256(nullptr, 0),
+                "e3b0c44298fc1c149afbf4c8996fb92427ae41e4649b934ca495991b7852b855");
+    CHECK_EQUAL(digest("abc"),
+                "ba7816bf8f01cfea414140de5dae2223b00361a396177a9cb410ff61f20015ad");
+    CHECK_EQUAL(digest("abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq"),
+                "248d6a61d20638b8e5c026930c3e6039a33ce45964ff2167f6ecedd419db06c1");
+    CHECK_EQUAL(digest(std::string(1000000, 'a')),
+                "cdc76e5c9914fb9281a1c7e284d73e67f1809a48a497200e046d39ccc7112cd0");
+    // Padding boundaries: 55 bytes fit in one block, 56 bytes need two
+    CHECK_EQUAL(digest(std::string(55, 'a')),
+                "9f4390f8d30c2dd92ec9f095b65e2b9ae9b0a925a5258e241c9f1e910f734318");
+    CHECK_EQUAL(digest(std::string(56, 'a')),
+                "b35439a4ac6f0948b6d6f9e3c6af0f5f590ce20f1bde7090ef7970686ec6738a");
+
+    CHECK_EQUAL(isS3Url("s3://bucket/key.jpg"), true);
+    CHECK_EQUAL(isS3Url("https://bucket/key.jpg"), false);
+
+    return checkResult("storage_test");
+}